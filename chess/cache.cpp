@@ -0,0 +1,213 @@
+/*
+This is a line-for-line remake of niklasf's 'python-chess' in C++
+All credit for the original code and algorithms go to niklasf and his credits
+The original source code can be found here: https://github.com/niklasf/python-chess
+*/
+
+#include "cache.h"
+
+namespace chess
+{
+    template <typename T>
+    PositionCache<T>::PositionCache(size_t capacity)
+    {
+        /*
+        Creates a cache with at least *capacity* entries, rounded up to a
+        power of two.
+        */
+        static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(Bitboard),
+                      "PositionCache values must be trivially copyable and at most 8 bytes");
+
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+
+        this->_checks = std::make_unique<std::atomic<Bitboard>[]>(size + _PROBE_WINDOW);
+        this->_values = std::make_unique<std::atomic<Bitboard>[]>(size + _PROBE_WINDOW);
+        this->_mask = size - 1;
+        this->clear();
+    }
+
+    template <typename T>
+    Bitboard PositionCache<T>::_encode(const T &value)
+    {
+        Bitboard bits = 0;
+        std::memcpy(&bits, &value, sizeof(T));
+        return bits;
+    }
+
+    template <typename T>
+    T PositionCache<T>::_decode(Bitboard bits)
+    {
+        T value;
+        std::memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    std::optional<T> PositionCache<T>::get(Bitboard key) const
+    {
+        size_t index = key & this->_mask;
+        for (size_t i = index; i < index + _PROBE_WINDOW; ++i)
+        {
+            Bitboard value = this->_values[i].load(std::memory_order_relaxed);
+            Bitboard check = this->_checks[i].load(std::memory_order_relaxed);
+            if ((check ^ value) == key)
+            {
+                return _decode(value);
+            }
+        }
+        return std::nullopt;
+    }
+
+    template <typename T>
+    void PositionCache<T>::put(Bitboard key, const T &value)
+    {
+        Bitboard bits = _encode(value);
+        size_t index = key & this->_mask;
+
+        // Prefer refreshing an existing entry for the key, then an empty
+        // slot; otherwise always-replace at the primary slot.
+        size_t target = index;
+        for (size_t i = index; i < index + _PROBE_WINDOW; ++i)
+        {
+            Bitboard old_value = this->_values[i].load(std::memory_order_relaxed);
+            Bitboard old_check = this->_checks[i].load(std::memory_order_relaxed);
+            if ((old_check ^ old_value) == key)
+            {
+                target = i;
+                break;
+            }
+            if (!old_check && !old_value && target == index)
+            {
+                target = i;
+            }
+        }
+
+        this->_values[target].store(bits, std::memory_order_relaxed);
+        this->_checks[target].store(key ^ bits, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    void PositionCache<T>::clear()
+    {
+        for (size_t i = 0; i <= this->_mask + _PROBE_WINDOW; ++i)
+        {
+            this->_checks[i].store(0, std::memory_order_relaxed);
+            this->_values[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename T>
+    size_t PositionCache<T>::capacity() const
+    {
+        return this->_mask + 1;
+    }
+
+    template class PositionCache<int>;
+    template class PositionCache<Bitboard>;
+
+    Status cached_status(Board &board, PositionCache<int> &cache)
+    {
+        /*
+        Like :func:`chess::Board::status()`, memoized by position hash.
+
+        The key is salted per adapter, so one cache can safely back both
+        :func:`chess::cached_status()` and :func:`chess::cached_outcome()`.
+        */
+        Bitboard key = board.zobrist_hash() ^ 0x9159af25c5bd2d04;
+        std::optional<int> cached = cache.get(key);
+        if (cached)
+        {
+            return Status(*cached);
+        }
+
+        Status status = board.status();
+        cache.put(key, int(status));
+        return status;
+    }
+
+    std::optional<Outcome> cached_outcome(Board &board, PositionCache<int> &cache, bool claim_draw)
+    {
+        /*
+        Like :func:`chess::Board::outcome()`, memoizing the
+        position-intrinsic terminations (variant end, checkmate,
+        insufficient material, stalemate) by position hash. The
+        history-dependent terminations (the seventyfive-move rule,
+        repetitions and claimable draws) are evaluated fresh each call,
+        so the semantics match outcome() exactly.
+        */
+        // 0 = unknown, 1 = none of the intrinsic terminations, otherwise
+        // 2 + termination * 4 + winner (0 none, 1 white, 2 black).
+        Bitboard key = board.zobrist_hash() ^ 0x3290df214dc14e1b;
+        int encoded = cache.get(key).value_or(0);
+
+        if (!encoded)
+        {
+            std::optional<Outcome> intrinsic = std::nullopt;
+            if (board.is_variant_loss())
+            {
+                intrinsic = Outcome(Termination::VARIANT_LOSS, !board.turn);
+            }
+            else if (board.is_variant_win())
+            {
+                intrinsic = Outcome(Termination::VARIANT_WIN, board.turn);
+            }
+            else if (board.is_variant_draw())
+            {
+                intrinsic = Outcome(Termination::VARIANT_DRAW, std::nullopt);
+            }
+            else if (board.is_checkmate())
+            {
+                intrinsic = Outcome(Termination::CHECKMATE, !board.turn);
+            }
+            else if (board.is_insufficient_material())
+            {
+                intrinsic = Outcome(Termination::INSUFFICIENT_MATERIAL, std::nullopt);
+            }
+            else if (!board.has_any_legal_move())
+            {
+                intrinsic = Outcome(Termination::STALEMATE, std::nullopt);
+            }
+
+            encoded = intrinsic == std::nullopt
+                          ? 1
+                          : 2 + int(intrinsic->termination) * 4 +
+                                (intrinsic->winner == std::nullopt ? 0 : *intrinsic->winner ? 1
+                                                                                            : 2);
+            cache.put(key, encoded);
+        }
+
+        if (encoded >= 2)
+        {
+            Termination termination = Termination((encoded - 2) / 4);
+            int winner = (encoded - 2) % 4;
+            return Outcome(termination, winner == 0 ? std::nullopt : std::optional<Color>(winner == 1));
+        }
+
+        // No intrinsic termination; check the history-dependent ones.
+        if (board.is_seventyfive_moves())
+        {
+            return Outcome(Termination::SEVENTYFIVE_MOVES, std::nullopt);
+        }
+        if (board.is_fivefold_repetition())
+        {
+            return Outcome(Termination::FIVEFOLD_REPETITION, std::nullopt);
+        }
+        if (claim_draw)
+        {
+            if (board.can_claim_fifty_moves())
+            {
+                return Outcome(Termination::FIFTY_MOVES, std::nullopt);
+            }
+            if (board.can_claim_threefold_repetition())
+            {
+                return Outcome(Termination::THREEFOLD_REPETITION, std::nullopt);
+            }
+        }
+
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,57 @@
+/*
+This is a line-for-line remake of niklasf's 'python-chess' in C++
+All credit for the original code and algorithms go to niklasf and his credits
+The original source code can be found here: https://github.com/niklasf/python-chess
+*/
+
+#include "chess.cpp"
+
+#include <atomic>
+#include <cstring>
+
+namespace chess
+{
+    template <typename T>
+    class PositionCache
+    {
+        /*
+        A fixed-size, thread-safe cache of small values keyed by a
+        position hash (:func:`chess::Board::zobrist_hash()`).
+
+        Open addressing over a power-of-two table with a short probe
+        window and always-replace eviction. Entries are stored lock-free:
+        the key slot holds ``key ^ value``, so a torn read from a
+        concurrent writer fails validation instead of returning a wrong
+        value, and any number of threads can share one table without
+        contention.
+
+        *T* must be trivially copyable and at most 8 bytes.
+        */
+
+    public:
+        PositionCache(size_t);
+
+        std::optional<T> get(Bitboard) const;
+
+        void put(Bitboard, const T &);
+
+        void clear();
+
+        size_t capacity() const;
+
+    private:
+        static const size_t _PROBE_WINDOW = 4;
+
+        std::unique_ptr<std::atomic<Bitboard>[]> _checks;
+        std::unique_ptr<std::atomic<Bitboard>[]> _values;
+        size_t _mask;
+
+        static Bitboard _encode(const T &);
+
+        static T _decode(Bitboard);
+    };
+
+    Status cached_status(Board &, PositionCache<int> &);
+
+    std::optional<Outcome> cached_outcome(Board &, PositionCache<int> &, bool = false);
+}
@@ -20,6 +20,27 @@ namespace chess
         return *PIECE_SYMBOLS[piece_type];
     }
 
+    std::optional<PieceType> _piece_type_from_symbol(char symbol)
+    {
+        switch (symbol)
+        {
+        case 'p':
+            return PAWN;
+        case 'n':
+            return KNIGHT;
+        case 'b':
+            return BISHOP;
+        case 'r':
+            return ROOK;
+        case 'q':
+            return QUEEN;
+        case 'k':
+            return KING;
+        default:
+            return std::nullopt;
+        }
+    }
+
     std::string piece_name(PieceType piece_type)
     {
         return *PIECE_NAMES[piece_type];
@@ -95,12 +116,11 @@ namespace chess
 
         :throws: :exc:`std::invalid_argument` if the square name is invalid.
         */
-        auto it = std::find(std::begin(SQUARE_NAMES), std::end(SQUARE_NAMES), name);
-        if (it == std::end(SQUARE_NAMES))
+        if (name.length() != 2 || name[0] < 'a' || name[0] > 'h' || name[1] < '1' || name[1] > '8')
         {
             throw std::invalid_argument("square name is invalid");
         }
-        return std::distance(SQUARE_NAMES, it);
+        return square(name[0] - 'a', name[1] - '1');
     }
 
     std::string square_name(Square square)
@@ -109,72 +129,116 @@ namespace chess
         return SQUARE_NAMES[square];
     }
 
-    Square square(int file_index, int rank_index)
+    int lsb(Bitboard bb)
+    {
+        return std::numeric_limits<Bitboard>::digits - std::countl_zero(bb & -bb) - 1;
+    }
+
+    _ScanForward::iterator::iterator(Bitboard bb) : _bb(bb) {}
+
+    Square _ScanForward::iterator::operator*() const
     {
-        /* Gets a square number by file and rank index. */
-        return rank_index * 8 + file_index;
+        return lsb(this->_bb);
     }
 
-    int square_file(Square square)
+    _ScanForward::iterator &_ScanForward::iterator::operator++()
     {
-        /* Gets the file index of the square where ``0`` is the a-file. */
-        return square & 7;
+        this->_bb &= this->_bb - 1;
+        return *this;
     }
 
-    int square_rank(Square square)
+    bool _ScanForward::iterator::operator==(const iterator &other) const
     {
-        /* Gets the rank index of the square where ``0`` is the first rank. */
-        return square >> 3;
+        return this->_bb == other._bb;
     }
 
-    int square_distance(Square a, Square b)
+    bool _ScanForward::iterator::operator!=(const iterator &other) const
     {
-        /*
-        Gets the distance (i.e., the number of king steps) from square *a* to *b*.
-        */
-        return std::max(abs(square_file(a) - square_file(b)), abs(square_rank(a) - square_rank(b)));
+        return this->_bb != other._bb;
     }
 
-    Square square_mirror(Square square)
+    _ScanForward::_ScanForward(Bitboard bb) : _bb(bb) {}
+
+    _ScanForward::iterator _ScanForward::begin() const
     {
-        /* Mirrors the square vertically. */
-        return square ^ 0x38;
+        return iterator(this->_bb);
     }
 
-    int lsb(Bitboard bb)
+    _ScanForward::iterator _ScanForward::end() const
     {
-        return std::numeric_limits<Bitboard>::digits - std::countl_zero(bb & -bb) - 1;
+        return iterator(BB_EMPTY);
     }
 
-    std::vector<Square> scan_forward(Bitboard bb)
+    _ScanForward::operator std::vector<Square>() const
     {
         std::vector<Square> iter;
-        while (bb)
+        for (Square square : *this)
         {
-            Bitboard r = bb & -bb;
-            iter.push_back(std::numeric_limits<Bitboard>::digits - std::countl_zero(r) - 1);
-            bb ^= r;
+            iter.push_back(square);
         }
         return iter;
     }
 
+    _ScanForward scan_forward(Bitboard bb)
+    {
+        return _ScanForward(bb);
+    }
+
     int msb(Bitboard bb)
     {
         return std::numeric_limits<Bitboard>::digits - std::countl_zero(bb) - 1;
     }
 
-    std::vector<Square> scan_reversed(Bitboard bb)
+    _ScanReversed::iterator::iterator(Bitboard bb) : _bb(bb) {}
+
+    Square _ScanReversed::iterator::operator*() const
+    {
+        return msb(this->_bb);
+    }
+
+    _ScanReversed::iterator &_ScanReversed::iterator::operator++()
+    {
+        this->_bb ^= BB_SQUARES[msb(this->_bb)];
+        return *this;
+    }
+
+    bool _ScanReversed::iterator::operator==(const iterator &other) const
+    {
+        return this->_bb == other._bb;
+    }
+
+    bool _ScanReversed::iterator::operator!=(const iterator &other) const
+    {
+        return this->_bb != other._bb;
+    }
+
+    _ScanReversed::_ScanReversed(Bitboard bb) : _bb(bb) {}
+
+    _ScanReversed::iterator _ScanReversed::begin() const
+    {
+        return iterator(this->_bb);
+    }
+
+    _ScanReversed::iterator _ScanReversed::end() const
+    {
+        return iterator(BB_EMPTY);
+    }
+
+    _ScanReversed::operator std::vector<Square>() const
     {
         std::vector<Square> iter;
-        while (bb)
+        for (Square square : *this)
         {
-            Square r = std::numeric_limits<Bitboard>::digits - std::countl_zero(bb) - 1;
-            iter.push_back(r);
-            bb ^= BB_SQUARES[r];
+            iter.push_back(square);
         }
         return iter;
     }
 
+    _ScanReversed scan_reversed(Bitboard bb)
+    {
+        return _ScanReversed(bb);
+    }
+
     Bitboard flip_vertical(Bitboard bb)
     {
         // https://www.chessprogramming.org/Flipping_Mirroring_and_Rotating#FlipVertically
@@ -277,125 +341,272 @@ namespace chess
         return (b >> 7) & ~BB_FILE_A;
     }
 
-    Bitboard _sliding_attacks(Square square, Bitboard occupied, const std::vector<int> &deltas)
+    std::vector<Bitboard> _carry_rippler(Bitboard mask)
     {
-        Bitboard attacks = BB_EMPTY;
-
-        for (int delta : deltas)
+        // Carry-Rippler trick to iterate subsets of mask.
+        std::vector<Bitboard> iter;
+        Bitboard subset = BB_EMPTY;
+        while (true)
         {
-            Square sq = square;
-
-            while (true)
+            iter.push_back(subset);
+            subset = (subset - mask) & mask;
+            if (!subset)
             {
-                sq += delta;
-                if (!(0 <= sq && sq < 64) || square_distance(sq, sq - delta) > 2)
-                {
-                    break;
-                }
-
-                attacks |= BB_SQUARES[sq];
-
-                if (occupied & BB_SQUARES[sq])
-                {
-                    break;
-                }
+                break;
             }
         }
-
-        return attacks;
+        return iter;
     }
 
-    Bitboard _step_attacks(Square square, const std::vector<int> &deltas)
+    Bitboard _fill_attacks(Bitboard sliders, Bitboard empty, Bitboard (*shift)(Bitboard))
     {
-        return _sliding_attacks(square, BB_ALL, deltas);
+        // Set-wise occluded fill: the squares attacked by every slider in
+        // *sliders* along one direction at once, sliding through *empty*.
+        Bitboard flood = BB_EMPTY;
+        while (sliders)
+        {
+            sliders = shift(sliders);
+            flood |= sliders;
+            sliders &= empty;
+        }
+        return flood;
     }
 
-    Bitboard _edges(Square square)
+    Bitboard _MagicAttacks::at(Bitboard occupied) const
     {
-        return (((BB_RANK_1 | BB_RANK_8) & ~BB_RANKS[square_rank(square)]) |
-                ((BB_FILE_A | BB_FILE_H) & ~BB_FILES[square_file(square)]));
+        _CHESS_STATS_COUNT(attack_lookups);
+        return this->table[(occupied & this->mask) * this->magic >> this->shift];
     }
 
-    std::vector<Bitboard> _carry_rippler(Bitboard mask)
+    _MagicAttacks _find_magic(Bitboard mask, const std::vector<Bitboard> &subsets, const std::vector<Bitboard> &attacks)
     {
-        // Carry-Rippler trick to iterate subsets of mask.
-        std::vector<Bitboard> iter;
-        Bitboard subset = BB_EMPTY;
+        // Searches a fixed-shift magic factor by trial: sparse candidates
+        // from a fixed-seed splitmix64, so the tables are deterministic.
+        static Bitboard state = 0x70242d1a5c9059c3;
+        auto next = []() -> Bitboard
+        {
+            Bitboard z = (state += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return z ^ (z >> 31);
+        };
+
+        _MagicAttacks magic_attacks;
+        magic_attacks.mask = mask;
+        magic_attacks.shift = std::numeric_limits<Bitboard>::digits - popcount(mask);
+
         while (true)
         {
-            iter.push_back(subset);
-            subset = (subset - mask) & mask;
-            if (!subset)
+            magic_attacks.magic = next() & next() & next();
+            magic_attacks.table.assign(1UL << popcount(mask), BB_EMPTY);
+
+            bool collision = false;
+            for (size_t i = 0; i < subsets.size(); ++i)
             {
-                break;
+                Bitboard &entry = magic_attacks.table[subsets[i] * magic_attacks.magic >> magic_attacks.shift];
+                if (entry && entry != attacks[i])
+                {
+                    collision = true;
+                    break;
+                }
+                entry = attacks[i];
+            }
+            if (!collision)
+            {
+                return magic_attacks;
             }
         }
-        return iter;
     }
 
-    std::tuple<std::vector<Bitboard>, std::vector<std::unordered_map<Bitboard, Bitboard>>> _attack_table(const std::vector<int> &deltas)
+    std::tuple<std::vector<Bitboard>, std::vector<_MagicAttacks>> _attack_table(const std::vector<int> &deltas)
     {
         std::vector<Bitboard> mask_table;
-        std::vector<std::unordered_map<Bitboard, Bitboard>> attack_table;
+        std::vector<_MagicAttacks> attack_table;
 
         for (Square square : SQUARES)
         {
-            std::unordered_map<Bitboard, Bitboard> attacks;
-
             Bitboard mask = _sliding_attacks(square, 0, deltas) & ~_edges(square);
-            for (Bitboard subset : _carry_rippler(mask))
+
+            std::vector<Bitboard> subsets = _carry_rippler(mask);
+            std::vector<Bitboard> attacks;
+            for (Bitboard subset : subsets)
             {
-                attacks[subset] = _sliding_attacks(square, subset, deltas);
+                attacks.push_back(_sliding_attacks(square, subset, deltas));
             }
 
-            attack_table.push_back(attacks);
+            attack_table.push_back(_find_magic(mask, subsets, attacks));
             mask_table.push_back(mask);
         }
 
         return {mask_table, attack_table};
     }
 
-    std::vector<std::vector<Bitboard>> _rays()
+    Bitboard ray(Square a, Square b)
+    {
+        return BB_RAYS[a][b];
+    }
+
+    Bitboard between(Square a, Square b)
+    {
+        Bitboard bb = BB_RAYS[a][b] & ((BB_ALL << a) ^ (BB_ALL << b));
+        return bb & (bb - 1);
+    }
+
+    bool _san_tokens(const std::string &san, char &piece, int &from_file, int &from_rank, int &to_file, int &to_rank, char &promotion)
     {
-        std::vector<std::vector<Bitboard>> rays;
-        for (int a = 0; a < 64; ++a)
+        // Hand-rolled equivalent of SAN_REGEX: an optional piece letter,
+        // optional disambiguation file/rank, an optional separator, the
+        // target square, an optional promotion and an optional check or
+        // checkmate suffix.
+        size_t end = san.length();
+        piece = promotion = 0;
+        from_file = from_rank = -1;
+
+        if (end && (san[end - 1] == '+' || san[end - 1] == '#'))
+        {
+            --end;
+        }
+
+        if (end)
         {
-            Bitboard bb_a = BB_SQUARES[a];
-            std::vector<Bitboard> rays_row;
-            for (int b = 0; b < 64; ++b)
+            char c = std::tolower(san[end - 1]);
+            if (c == 'n' || c == 'b' || c == 'r' || c == 'q' || c == 'k')
             {
-                Bitboard bb_b = BB_SQUARES[b];
-                if (BB_DIAG_ATTACKS[a].at(0) & bb_b)
-                {
-                    rays_row.push_back((BB_DIAG_ATTACKS[a].at(0) & BB_DIAG_ATTACKS[b].at(0)) | bb_a | bb_b);
-                }
-                else if (BB_RANK_ATTACKS[a].at(0) & bb_b)
-                {
-                    rays_row.push_back(BB_RANK_ATTACKS[a].at(0) | bb_a);
-                }
-                else if (BB_FILE_ATTACKS[a].at(0) & bb_b)
-                {
-                    rays_row.push_back(BB_FILE_ATTACKS[a].at(0) | bb_a);
-                }
-                else
+                promotion = c;
+                --end;
+                if (end && san[end - 1] == '=')
                 {
-                    rays_row.push_back(BB_EMPTY);
+                    --end;
                 }
             }
-            rays.push_back(rays_row);
         }
-        return rays;
+
+        if (end < 2)
+        {
+            return false;
+        }
+        to_file = san[end - 2] - 'a';
+        to_rank = san[end - 1] - '1';
+        if (to_file < 0 || to_file > 7 || to_rank < 0 || to_rank > 7)
+        {
+            return false;
+        }
+        end -= 2;
+
+        size_t i = 0;
+        if (i < end && (san[i] == 'N' || san[i] == 'B' || san[i] == 'K' || san[i] == 'R' || san[i] == 'Q'))
+        {
+            piece = san[i++];
+        }
+        if (i < end && 'a' <= san[i] && san[i] <= 'h')
+        {
+            from_file = san[i++] - 'a';
+        }
+        if (i < end && '1' <= san[i] && san[i] <= '8')
+        {
+            from_rank = san[i++] - '1';
+        }
+        if (i < end && (san[i] == '-' || san[i] == 'x'))
+        {
+            ++i;
+        }
+        return i == end;
     }
 
-    Bitboard ray(Square a, Square b)
+    bool _valid_castling_fen(std::string_view castling_fen)
     {
-        return BB_RAYS[a][b];
+        // Hand-rolled equivalent of FEN_CASTLING_REGEX: "-" or up to two
+        // upper-case flags followed by up to two lower-case flags.
+        if (castling_fen == "-")
+        {
+            return true;
+        }
+
+        size_t i = 0;
+        for (size_t count = 0; i < castling_fen.length() && count < 2; ++count)
+        {
+            char c = castling_fen[i];
+            if (c == 'K' || c == 'Q' || ('A' <= c && c <= 'H'))
+            {
+                ++i;
+            }
+            else
+            {
+                break;
+            }
+        }
+        for (size_t count = 0; i < castling_fen.length() && count < 2; ++count)
+        {
+            char c = castling_fen[i];
+            if (c == 'k' || c == 'q' || ('a' <= c && c <= 'h'))
+            {
+                ++i;
+            }
+            else
+            {
+                break;
+            }
+        }
+        return i == castling_fen.length();
     }
 
-    Bitboard between(Square a, Square b)
+    namespace stats
     {
-        Bitboard bb = BB_RAYS[a][b] & ((BB_ALL << a) ^ (BB_ALL << b));
-        return bb & (bb - 1);
+#ifdef CHESS_ENABLE_STATS
+        _Counters _counters;
+
+        unsigned long long _now()
+        {
+#ifdef __x86_64__
+            return __builtin_ia32_rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+#endif
+        }
+
+        Snapshot snapshot()
+        {
+            /* Gets a consistent-enough copy of the per-process counters. */
+            Snapshot s;
+            s.generate_legal_moves_calls = _counters.generate_legal_moves.calls;
+            s.generate_legal_moves_ticks = _counters.generate_legal_moves.ticks;
+            s.push_calls = _counters.push.calls;
+            s.push_ticks = _counters.push.ticks;
+            s.pop_calls = _counters.pop.calls;
+            s.pop_ticks = _counters.pop.ticks;
+            s.parse_san_calls = _counters.parse_san.calls;
+            s.parse_san_ticks = _counters.parse_san.ticks;
+            s.set_fen_calls = _counters.set_fen.calls;
+            s.set_fen_ticks = _counters.set_fen.ticks;
+            s.is_game_over_calls = _counters.is_game_over.calls;
+            s.is_game_over_ticks = _counters.is_game_over.ticks;
+            s.attack_lookups = _counters.attack_lookups;
+            return s;
+        }
+
+        void reset()
+        {
+            for (_Counter *counter : {&_counters.generate_legal_moves, &_counters.push, &_counters.pop,
+                                      &_counters.parse_san, &_counters.set_fen, &_counters.is_game_over})
+            {
+                counter->calls = 0;
+                counter->ticks = 0;
+            }
+            _counters.attack_lookups = 0;
+        }
+#else
+        Snapshot snapshot()
+        {
+            /* Without CHESS_ENABLE_STATS all counters read as zero. */
+            return Snapshot{};
+        }
+
+        void reset()
+        {
+        }
+#endif
     }
 
     Piece::Piece(PieceType piece_type, Color color) : piece_type(piece_type), color(color) {}
@@ -475,6 +686,25 @@ namespace chess
         }
     }
 
+    unsigned short Move::pack() const
+    {
+        /*
+        Packs the move into 16 bits: six bits each for the source and
+        target square, three bits for the promotion (or, with the high bit
+        set, the drop) piece type. A null move packs to ``0``.
+        */
+        unsigned short packed = this->from_square | this->to_square << 6;
+        if (this->drop)
+        {
+            packed |= *this->drop << 12 | 1 << 15;
+        }
+        else if (this->promotion)
+        {
+            packed |= *this->promotion << 12;
+        }
+        return packed;
+    }
+
     std::string Move::xboard() const
     {
         return *this ? this->uci() : "@@@@";
@@ -485,6 +715,14 @@ namespace chess
         return bool(this->from_square || this->to_square || this->promotion || this->drop);
     }
 
+    bool Move::operator==(const Move &move) const
+    {
+        return (this->from_square == move.from_square &&
+                this->to_square == move.to_square &&
+                this->promotion == move.promotion &&
+                this->drop == move.drop);
+    }
+
     Move::operator std::string() const
     {
         return this->uci();
@@ -503,43 +741,35 @@ namespace chess
         }
         else if (uci.length() == 4 && '@' == uci[1])
         {
-            auto it = std::find(std::begin(PIECE_SYMBOLS), std::end(PIECE_SYMBOLS), std::tolower(uci[0]));
-            if (it == std::end(PIECE_SYMBOLS))
+            std::optional<PieceType> drop = _piece_type_from_symbol(std::tolower(uci[0]));
+            if (drop == std::nullopt)
             {
                 throw std::invalid_argument("");
             }
-            Square drop = std::distance(PIECE_SYMBOLS, it);
-            auto it2 = std::find(std::begin(SQUARE_NAMES), std::end(SQUARE_NAMES), uci.substr(2));
-            if (it2 == std::end(SQUARE_NAMES))
+            if (uci[2] < 'a' || uci[2] > 'h' || uci[3] < '1' || uci[3] > '8')
             {
                 throw std::invalid_argument("");
             }
-            Square square = std::distance(SQUARE_NAMES, it2);
-            return Move(square, square, drop);
+            Square square = chess::square(uci[2] - 'a', uci[3] - '1');
+            return Move(square, square, std::nullopt, drop);
         }
         else if (4 <= uci.length() && uci.length() <= 5)
         {
-            auto it = std::find(std::begin(SQUARE_NAMES), std::end(SQUARE_NAMES), uci.substr(0, 2));
-            if (it == std::end(SQUARE_NAMES))
-            {
-                throw std::invalid_argument("");
-            }
-            Square from_square = std::distance(SQUARE_NAMES, it);
-            auto it2 = std::find(std::begin(SQUARE_NAMES), std::end(SQUARE_NAMES), uci.substr(2, 4));
-            if (it2 == std::end(SQUARE_NAMES))
+            if (uci[0] < 'a' || uci[0] > 'h' || uci[1] < '1' || uci[1] > '8' ||
+                uci[2] < 'a' || uci[2] > 'h' || uci[3] < '1' || uci[3] > '8')
             {
                 throw std::invalid_argument("");
             }
-            Square to_square = std::distance(SQUARE_NAMES, it2);
-            std::optional<Square> promotion;
+            Square from_square = chess::square(uci[0] - 'a', uci[1] - '1');
+            Square to_square = chess::square(uci[2] - 'a', uci[3] - '1');
+            std::optional<PieceType> promotion;
             if (uci.length() == 5)
             {
-                auto it3 = std::find(std::begin(PIECE_SYMBOLS), std::end(PIECE_SYMBOLS), uci[4]);
-                if (it3 == std::end(PIECE_SYMBOLS))
+                promotion = _piece_type_from_symbol(uci[4]);
+                if (promotion == std::nullopt)
                 {
                     throw std::invalid_argument("");
                 }
-                promotion = std::distance(PIECE_SYMBOLS, it3);
             }
             else
             {
@@ -557,6 +787,19 @@ namespace chess
         }
     }
 
+    Move Move::unpack(unsigned short packed)
+    {
+        /* Unpacks a move packed by :func:`~chess::Move::pack()`. */
+        Square from_square = packed & 0x3f;
+        Square to_square = packed >> 6 & 0x3f;
+        PieceType piece_type = packed >> 12 & 0x7;
+        if (packed & 1 << 15)
+        {
+            return Move(from_square, to_square, std::nullopt, piece_type);
+        }
+        return Move(from_square, to_square, piece_type ? std::optional(piece_type) : std::nullopt);
+    }
+
     Move Move::null()
     {
         /*
@@ -769,6 +1012,116 @@ namespace chess
         }
     }
 
+    void BaseBoard::all_attacks(std::array<Bitboard, 64> &attacks) const
+    {
+        /*
+        Fills *attacks* with the attack mask of every occupied square in
+        one pass over the piece-type bitboards, without the per-square
+        piece-type branching of :func:`~chess::BaseBoard::attacks_mask()`.
+        Unoccupied squares are set to ``BB_EMPTY``.
+        */
+        attacks.fill(BB_EMPTY);
+
+        for (Square square : scan_forward(this->pawns & this->occupied_co[WHITE]))
+        {
+            attacks[square] = BB_PAWN_ATTACKS[WHITE][square];
+        }
+        for (Square square : scan_forward(this->pawns & this->occupied_co[BLACK]))
+        {
+            attacks[square] = BB_PAWN_ATTACKS[BLACK][square];
+        }
+        for (Square square : scan_forward(this->knights))
+        {
+            attacks[square] = BB_KNIGHT_ATTACKS[square];
+        }
+        for (Square square : scan_forward(this->kings))
+        {
+            attacks[square] = BB_KING_ATTACKS[square];
+        }
+        for (Square square : scan_forward(this->bishops | this->queens))
+        {
+            attacks[square] = BB_DIAG_ATTACKS[square].at(BB_DIAG_MASKS[square] & this->occupied);
+        }
+        for (Square square : scan_forward(this->rooks | this->queens))
+        {
+            attacks[square] |= (BB_RANK_ATTACKS[square].at(BB_RANK_MASKS[square] & this->occupied) |
+                                BB_FILE_ATTACKS[square].at(BB_FILE_MASKS[square] & this->occupied));
+        }
+    }
+
+    Bitboard BaseBoard::color_attacks_mask(Color color) const
+    {
+        /*
+        Gets the union of all squares attacked by the given side, computed
+        with branchless set-wise fills over whole piece bitboards instead
+        of per-square lookups.
+        */
+        Bitboard own = this->occupied_co[color];
+        Bitboard empty = ~this->occupied;
+
+        Bitboard attacks = color == WHITE ? (shift_up_left(this->pawns & own) | shift_up_right(this->pawns & own))
+                                          : (shift_down_left(this->pawns & own) | shift_down_right(this->pawns & own));
+
+        for (Square square : scan_forward(this->knights & own))
+        {
+            attacks |= BB_KNIGHT_ATTACKS[square];
+        }
+        for (Square square : scan_forward(this->kings & own))
+        {
+            attacks |= BB_KING_ATTACKS[square];
+        }
+
+        Bitboard diag_sliders = (this->bishops | this->queens) & own;
+        Bitboard line_sliders = (this->rooks | this->queens) & own;
+        attacks |= _fill_attacks(diag_sliders, empty, shift_up_left);
+        attacks |= _fill_attacks(diag_sliders, empty, shift_up_right);
+        attacks |= _fill_attacks(diag_sliders, empty, shift_down_left);
+        attacks |= _fill_attacks(diag_sliders, empty, shift_down_right);
+        attacks |= _fill_attacks(line_sliders, empty, shift_up);
+        attacks |= _fill_attacks(line_sliders, empty, shift_down);
+        attacks |= _fill_attacks(line_sliders, empty, shift_left);
+        attacks |= _fill_attacks(line_sliders, empty, shift_right);
+
+        return attacks;
+    }
+
+    int BaseBoard::mobility(Color color) const
+    {
+        /*
+        Counts the attacked squares of the given side, per piece, excluding
+        squares occupied by its own pieces. A cheap feature-extraction
+        measure, not a legal move count.
+        */
+        Bitboard own = this->occupied_co[color];
+        Bitboard targets = ~own;
+        int count = 0;
+
+        for (Square square : scan_forward(this->pawns & own))
+        {
+            count += popcount(BB_PAWN_ATTACKS[color][square] & targets);
+        }
+        for (Square square : scan_forward(this->knights & own))
+        {
+            count += popcount(BB_KNIGHT_ATTACKS[square] & targets);
+        }
+        for (Square square : scan_forward(this->kings & own))
+        {
+            count += popcount(BB_KING_ATTACKS[square] & targets);
+        }
+        for (Square square : scan_forward((this->bishops | this->queens) & own))
+        {
+            count += popcount(BB_DIAG_ATTACKS[square].at(BB_DIAG_MASKS[square] & this->occupied) & targets);
+        }
+        for (Square square : scan_forward((this->rooks | this->queens) & own))
+        {
+            count += popcount((BB_RANK_ATTACKS[square].at(BB_RANK_MASKS[square] & this->occupied) |
+                               BB_FILE_ATTACKS[square].at(BB_FILE_MASKS[square] & this->occupied)) &
+                              targets);
+        }
+
+        return count;
+    }
+
     chess::SquareSet BaseBoard::attacks(Square square) const
     {
         /*
@@ -916,47 +1269,46 @@ namespace chess
         Gets the board FEN (e.g.,
         ``rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR``).
         */
-        std::vector<char> builder;
-        int empty = 0;
+        // Symbols indexed by the mailbox plane codes.
+        const char symbols[] = {0, 'p', 'P', 'n', 'N', 'b', 'B', 'r', 'R', 'q', 'Q', 'k', 'K'};
+        unsigned char plane[64];
+        this->_piece_plane(plane);
 
-        for (Square square : SQUARES_180)
+        char buffer[90];
+        char *out = buffer;
+        for (int rank = 7; rank >= 0; --rank)
         {
-            std::optional<Piece> piece = this->piece_at(square);
-
-            if (!piece)
+            int empty = 0;
+            for (int file = 0; file < 8; ++file)
             {
-                ++empty;
-            }
-            else
-            {
-                if (empty)
-                {
-                    builder.push_back(std::to_string(empty)[0]);
-                    empty = 0;
-                }
-                builder.push_back(piece->symbol());
-                if (promoted && BB_SQUARES[square] & this->promoted)
+                Square sq = square(file, rank);
+                if (!plane[sq])
                 {
-                    builder.push_back('~');
+                    ++empty;
+                    continue;
                 }
-            }
-
-            if (BB_SQUARES[square] & BB_FILE_H)
-            {
                 if (empty)
                 {
-                    builder.push_back(std::to_string(empty)[0]);
+                    *out++ = '0' + empty;
                     empty = 0;
                 }
-
-                if (square != H1)
+                *out++ = symbols[plane[sq]];
+                if (promoted && *promoted && BB_SQUARES[sq] & this->promoted)
                 {
-                    builder.push_back('/');
+                    *out++ = '~';
                 }
             }
+            if (empty)
+            {
+                *out++ = '0' + empty;
+            }
+            if (rank)
+            {
+                *out++ = '/';
+            }
         }
 
-        return std::string(std::begin(builder), std::end(builder));
+        return std::string(buffer, out);
     }
 
     void BaseBoard::set_board_fen(const std::string &fen)
@@ -1166,6 +1518,11 @@ namespace chess
         :param invert_color: Invert color of the Unicode pieces.
         :param borders: Show borders and a coordinate margin.
         */
+        // Unicode symbols indexed by the mailbox plane codes.
+        const std::string symbols[] = {"", "♟", "♙", "♞", "♘", "♝", "♗", "♜", "♖", "♛", "♕", "♚", "♔"};
+        unsigned char plane[64];
+        this->_piece_plane(plane);
+
         std::vector<char> builder;
         for (int rank_index = 7; rank_index >= 0; --rank_index)
         {
@@ -1192,11 +1549,11 @@ namespace chess
                     builder.push_back(' ');
                 }
 
-                std::optional<Piece> piece = this->piece_at(square_index);
+                unsigned char code = plane[square_index];
 
-                if (piece)
+                if (code)
                 {
-                    std::string unicode_symbol = piece->unicode_symbol(invert_color);
+                    const std::string &unicode_symbol = symbols[invert_color ? ((code - 1) ^ 1) + 1 : code];
                     builder.insert(std::end(builder), std::begin(unicode_symbol), std::end(unicode_symbol));
                 }
                 else
@@ -1253,6 +1610,8 @@ namespace chess
         this->occupied_co[BLACK] = f(this->occupied_co[BLACK]);
         this->occupied = f(this->occupied);
         this->promoted = f(this->promoted);
+
+        this->_hash_key = this->_compute_hash_key();
     }
 
     BaseBoard BaseBoard::transform(const std::function<Bitboard(Bitboard)> &f) const
@@ -1279,6 +1638,7 @@ namespace chess
     {
         this->apply_transform(flip_vertical);
         std::swap(this->occupied_co[WHITE], this->occupied_co[BLACK]);
+        this->_hash_key = this->_compute_hash_key();
     }
 
     BaseBoard BaseBoard::mirror() const
@@ -1314,6 +1674,8 @@ namespace chess
         board.occupied = this->occupied;
         board.promoted = this->promoted;
 
+        board._hash_key = this->_hash_key;
+
         return board;
     }
 
@@ -1357,6 +1719,8 @@ namespace chess
         this->occupied_co[WHITE] = BB_RANK_1 | BB_RANK_2;
         this->occupied_co[BLACK] = BB_RANK_7 | BB_RANK_8;
         this->occupied = BB_RANK_1 | BB_RANK_2 | BB_RANK_7 | BB_RANK_8;
+
+        this->_hash_key = this->_compute_hash_key();
     }
 
     void BaseBoard::_clear_board()
@@ -1373,6 +1737,8 @@ namespace chess
         this->occupied_co[WHITE] = BB_EMPTY;
         this->occupied_co[BLACK] = BB_EMPTY;
         this->occupied = BB_EMPTY;
+
+        this->_hash_key = BB_EMPTY;
     }
 
     Bitboard BaseBoard::_attackers_mask(Color color, Square square, Bitboard occupied) const
@@ -1399,6 +1765,14 @@ namespace chess
         std::optional<PieceType> piece_type = this->piece_type_at(square);
         Bitboard mask = BB_SQUARES[square];
 
+        if (piece_type == std::nullopt)
+        {
+            return std::nullopt; // Early return
+        }
+
+        Color color = bool(this->occupied_co[WHITE] & mask);
+        this->_hash_key ^= ZOBRIST_RANDOM_ARRAY[64 * ((*piece_type - 1) * 2 + color) + square];
+
         if (*piece_type == PAWN)
         {
             this->pawns ^= mask;
@@ -1475,6 +1849,8 @@ namespace chess
         this->occupied ^= mask;
         this->occupied_co[color] ^= mask;
 
+        this->_hash_key ^= ZOBRIST_RANDOM_ARRAY[64 * ((piece_type - 1) * 2 + color) + square];
+
         if (promoted)
         {
             this->promoted ^= mask;
@@ -1486,11 +1862,11 @@ namespace chess
         // Compatibility with set_fen().
         auto it = begin(fen);
         auto it2 = rbegin(fen);
-        while (isspace(*it))
+        while (it != end(fen) && isspace(*it))
         {
             ++it;
         }
-        while (isspace(*it2))
+        while (it2 != rend(fen) && isspace(*it2))
         {
             ++it2;
         }
@@ -1501,69 +1877,62 @@ namespace chess
         }
 
         // Ensure the FEN is valid.
-        std::vector<std::string> rows;
-        for (size_t i = 0, dist = 0; i < fen.length(); ++i, ++dist)
-        {
-            if (fen[i] == '/')
-            {
-                rows.push_back(fen.substr(i++ - dist, dist));
-                dist = 0;
-            }
-            else if (i == fen.length() - 1)
-            {
-                rows.push_back(fen.substr(i - dist));
-            }
-        }
-        if (rows.size() != 8)
-        {
-            throw std::invalid_argument("expected 8 rows in position part of fen: \"" + fen + "\"");
-        }
+        int rows = 1;
+        int field_sum = 0;
+        bool previous_was_digit = false;
+        bool previous_was_piece = false;
 
-        // Validate each row.
-        for (const std::string &row : rows)
+        for (char c : fen)
         {
-            int field_sum = 0;
-            bool previous_was_digit = false;
-            bool previous_was_piece = false;
-
-            for (char c : row)
+            if (c == '/')
             {
-                if (c == '1' || c == '2' || c == '3' || c == '4' || c == '5' || c == '6' || c == '7' || c == '8')
-                {
-                    if (previous_was_digit)
-                    {
-                        throw std::invalid_argument("two subsequent digits in position part of fen: \"" + fen + "\"");
-                    }
-                    field_sum += c - '0';
-                    previous_was_digit = true;
-                    previous_was_piece = false;
-                }
-                else if (c == '~')
+                if (field_sum != 8)
                 {
-                    if (!previous_was_piece)
-                    {
-                        throw std::invalid_argument("'~' not after piece in position part of fen: \"" + fen + "\"");
-                    }
-                    previous_was_digit = false;
-                    previous_was_piece = false;
+                    throw std::invalid_argument("expected 8 columns per row in position part of fen: \"" + fen + "\"");
                 }
-                else if (std::find(std::begin(PIECE_SYMBOLS), std::end(PIECE_SYMBOLS), std::tolower(c)) != std::end(PIECE_SYMBOLS))
+                ++rows;
+                field_sum = 0;
+                previous_was_digit = false;
+                previous_was_piece = false;
+            }
+            else if ('1' <= c && c <= '8')
+            {
+                if (previous_was_digit)
                 {
-                    ++field_sum;
-                    previous_was_digit = false;
-                    previous_was_piece = true;
+                    throw std::invalid_argument("two subsequent digits in position part of fen: \"" + fen + "\"");
                 }
-                else
+                field_sum += c - '0';
+                previous_was_digit = true;
+                previous_was_piece = false;
+            }
+            else if (c == '~')
+            {
+                if (!previous_was_piece)
                 {
-                    throw std::invalid_argument("invalid character in position part of fen: \"" + fen + "\"");
+                    throw std::invalid_argument("'~' not after piece in position part of fen: \"" + fen + "\"");
                 }
+                previous_was_digit = false;
+                previous_was_piece = false;
             }
-
-            if (field_sum != 8)
+            else if (_piece_type_from_symbol(std::tolower(c)))
+            {
+                ++field_sum;
+                previous_was_digit = false;
+                previous_was_piece = true;
+            }
+            else
             {
-                throw std::invalid_argument("expected 8 columns per row in position part of fen: \"" + fen + "\"");
+                throw std::invalid_argument("invalid character in position part of fen: \"" + fen + "\"");
             }
         }
+        if (field_sum != 8)
+        {
+            throw std::invalid_argument("expected 8 columns per row in position part of fen: \"" + fen + "\"");
+        }
+        if (rows != 8)
+        {
+            throw std::invalid_argument("expected 8 rows in position part of fen: \"" + fen + "\"");
+        }
 
         // Clear the board.
         this->_clear_board();
@@ -1572,20 +1941,19 @@ namespace chess
         int square_index = 0;
         for (char c : fen)
         {
-            if (c == '1' || c == '2' || c == '3' || c == '4' || c == '5' || c == '6' || c == '7' || c == '8')
+            if ('1' <= c && c <= '8')
             {
                 square_index += c - '0';
             }
-            else if (std::find(std::begin(PIECE_SYMBOLS), std::end(PIECE_SYMBOLS), std::tolower(c)) != std::end(PIECE_SYMBOLS))
-            {
-                Piece piece = Piece::from_symbol(c);
-                this->_set_piece_at(SQUARES_180[square_index], piece.piece_type, piece.color);
-                ++square_index;
-            }
             else if (c == '~')
             {
                 this->promoted |= BB_SQUARES[SQUARES_180[square_index - 1]];
             }
+            else if (c != '/')
+            {
+                this->_set_piece_at(SQUARES_180[square_index], *_piece_type_from_symbol(std::tolower(c)), std::isupper(c));
+                ++square_index;
+            }
         }
     }
 
@@ -1598,94 +1966,65 @@ namespace chess
         }
     }
 
-    void BaseBoard::_set_chess960_pos(int scharnagl)
+    void BaseBoard::_piece_plane(unsigned char (&plane)[64]) const
     {
-        if (!(0 <= scharnagl && scharnagl <= 959))
-        {
-            throw std::invalid_argument("chess960 position index not 0 <= \"" + std::to_string(scharnagl) + "\" <= 959");
-        }
-
-        // See http://www.russellcottrell.com/Chess/Chess960.htm for
-        // a description of the algorithm.
-        int n = scharnagl / 4, bw = scharnagl % 4;
-        int bb = n % 4;
-        n /= 4;
-        int q = n % 6;
-        n /= 6;
+        // Decodes the bitboards into a 64-byte mailbox plane in one pass
+        // per piece type: 0 for empty squares, otherwise
+        // 1 + (piece_type - 1) * 2 + color. Rendering then becomes a
+        // linear walk over bytes instead of per-square bitboard probes.
+        std::memset(plane, 0, sizeof(plane));
 
-        int n1, n2;
-        for (n1 = 0; n1 < 4; ++n1)
+        const std::tuple<PieceType, Bitboard> planes[] = {
+            {PAWN, this->pawns},
+            {KNIGHT, this->knights},
+            {BISHOP, this->bishops},
+            {ROOK, this->rooks},
+            {QUEEN, this->queens},
+            {KING, this->kings},
+        };
+        for (auto [piece_type, mask] : planes)
         {
-            n2 = n + (3 - n1) * (4 - n1) / 2 - 5;
-            if (n1 < n2 && 1 <= n2 && n2 <= 4)
+            for (Square square : scan_forward(mask & this->occupied))
             {
-                break;
+                Color color = bool(this->occupied_co[WHITE] & BB_SQUARES[square]);
+                plane[square] = 1 + (piece_type - 1) * 2 + color;
             }
         }
+    }
 
-        // Bishops.
-        int bw_file = bw * 2 + 1;
-        int bb_file = bb * 2;
-        this->bishops = (BB_FILES[bw_file] | BB_FILES[bb_file]) & BB_BACKRANKS;
-
-        // Queens.
-        int q_file = q;
-        q_file += int(std::min(bw_file, bb_file) <= q_file);
-        q_file += int(std::max(bw_file, bb_file) <= q_file);
-        this->queens = BB_FILES[q_file] & BB_BACKRANKS;
-
-        std::vector<int> used = {bw_file, bb_file, q_file};
-
-        // Knights.
-        this->knights = BB_EMPTY;
-        for (int i = 0; i < 8; ++i)
+    Bitboard BaseBoard::_compute_hash_key() const
+    {
+        Bitboard key = BB_EMPTY;
+        for (Square square : scan_reversed(this->occupied))
         {
-            if (std::find(std::begin(used), std::end(used), i) == std::end(used))
-            {
-                if (n1 == 0 || n2 == 0)
-                {
-                    this->knights |= BB_FILES[i] & BB_BACKRANKS;
-                    used.push_back(i);
-                }
-                --n1;
-                --n2;
-            }
+            Color color = bool(this->occupied_co[WHITE] & BB_SQUARES[square]);
+            key ^= ZOBRIST_RANDOM_ARRAY[64 * ((*this->piece_type_at(square) - 1) * 2 + color) + square];
         }
+        return key;
+    }
 
-        // RKR.
-        for (int i = 0; i < 8; ++i)
-        {
-            if (std::find(std::begin(used), std::end(used), i) == std::end(used))
-            {
-                this->rooks = BB_FILES[i] & BB_BACKRANKS;
-                used.push_back(i);
-                break;
-            }
-        }
-        for (int i = 1; i < 8; ++i)
-        {
-            if (std::find(std::begin(used), std::end(used), i) == std::end(used))
-            {
-                this->kings = BB_FILES[i] & BB_BACKRANKS;
-                used.push_back(i);
-                break;
-            }
-        }
-        for (int i = 2; i < 8; ++i)
+    void BaseBoard::_set_chess960_pos(int scharnagl)
+    {
+        if (!(0 <= scharnagl && scharnagl <= 959))
         {
-            if (std::find(std::begin(used), std::end(used), i) == std::end(used))
-            {
-                this->rooks |= BB_FILES[i] & BB_BACKRANKS;
-                break;
-            }
+            throw std::invalid_argument("chess960 position index not 0 <= \"" + std::to_string(scharnagl) + "\" <= 959");
         }
 
-        // Finalize.
+        // Copy the precomputed arrangement into the bitboards.
+        const _Chess960Setup &setup = CHESS960_STARTING_POSITIONS[scharnagl];
+        this->knights = (Bitboard(setup.knights) | Bitboard(setup.knights) << 56) & BB_BACKRANKS;
+        this->bishops = (Bitboard(setup.bishops) | Bitboard(setup.bishops) << 56) & BB_BACKRANKS;
+        this->rooks = (Bitboard(setup.rooks) | Bitboard(setup.rooks) << 56) & BB_BACKRANKS;
+        this->queens = (Bitboard(setup.queens) | Bitboard(setup.queens) << 56) & BB_BACKRANKS;
+        this->kings = (Bitboard(setup.kings) | Bitboard(setup.kings) << 56) & BB_BACKRANKS;
+
         this->pawns = BB_RANK_2 | BB_RANK_7;
         this->occupied_co[WHITE] = BB_RANK_1 | BB_RANK_2;
         this->occupied_co[BLACK] = BB_RANK_7 | BB_RANK_8;
         this->occupied = BB_RANK_1 | BB_RANK_2 | BB_RANK_7 | BB_RANK_8;
         this->promoted = BB_EMPTY;
+
+        this->_hash_key = this->_compute_hash_key();
     }
 
     std::ostream &operator<<(std::ostream &os, const BaseBoard &board)
@@ -1709,6 +2048,8 @@ namespace chess
 
         this->promoted = board.promoted;
 
+        this->hash_key = board._hash_key;
+
         this->turn = board.turn;
         this->castling_rights = board.castling_rights;
         this->ep_square = board.ep_square;
@@ -1731,6 +2072,8 @@ namespace chess
 
         board.promoted = this->promoted;
 
+        board._hash_key = this->hash_key;
+
         board.turn = this->turn;
         board.castling_rights = this->castling_rights;
         board.ep_square = this->ep_square;
@@ -1870,6 +2213,50 @@ namespace chess
         this->_stack.clear();
     }
 
+    void Board::reset_to(const Board &board)
+    {
+        /*
+        Copies the position from *board* onto this board without
+        reallocating: the move and snapshot stacks are cleared but keep
+        their capacity, and the stacks of *board* are not copied. Use
+        :func:`~chess::Board::copy()` for a copy that includes them.
+        */
+        this->pawns = board.pawns;
+        this->knights = board.knights;
+        this->bishops = board.bishops;
+        this->rooks = board.rooks;
+        this->queens = board.queens;
+        this->kings = board.kings;
+
+        this->occupied_co[WHITE] = board.occupied_co[WHITE];
+        this->occupied_co[BLACK] = board.occupied_co[BLACK];
+        this->occupied = board.occupied;
+        this->promoted = board.promoted;
+        this->_hash_key = board._hash_key;
+
+        this->ep_square = board.ep_square;
+        this->castling_rights = board.castling_rights;
+        this->turn = board.turn;
+        this->fullmove_number = board.fullmove_number;
+        this->halfmove_clock = board.halfmove_clock;
+        this->chess960 = board.chess960;
+
+        this->move_stack.clear();
+        this->_stack.clear();
+    }
+
+    void Board::reserve_plies(int plies)
+    {
+        /*
+        Preallocates the move stack and the snapshot stack for *plies*
+        half-moves, so that :func:`~chess::Board::push()` never reallocates
+        while searching. The capacity survives
+        :func:`~chess::Board::clear_stack()`.
+        */
+        this->move_stack.reserve(plies);
+        this->_stack.reserve(plies);
+    }
+
     Board Board::root() const
     {
         /* Returns a copy of the root position. */
@@ -1912,9 +2299,25 @@ namespace chess
         this->clear_stack();
     }
 
-    std::vector<Move> Board::generate_pseudo_legal_moves(Bitboard from_mask, Bitboard to_mask) const
+    template <typename Visitor, typename Payload>
+    bool _visit_move(Visitor &visitor, const Payload &move)
+    {
+        // Invokes *visitor* with *move*. A visitor returning ``bool`` can
+        // abort the generation by returning ``false``.
+        if constexpr (std::is_convertible_v<decltype(visitor(move)), bool>)
+        {
+            return bool(visitor(move));
+        }
+        else
+        {
+            visitor(move);
+            return true;
+        }
+    }
+
+    template <typename Visitor>
+    bool Board::_visit_pseudo_legal_moves(Bitboard from_mask, Bitboard to_mask, Visitor &visitor) const
     {
-        std::vector<Move> iter;
         Bitboard our_pieces = this->occupied_co[this->turn];
 
         // Generate piece moves.
@@ -1924,16 +2327,19 @@ namespace chess
             Bitboard moves = this->attacks_mask(from_square) & ~our_pieces & to_mask;
             for (Square to_square : scan_reversed(moves))
             {
-                iter.push_back(Move(from_square, to_square));
+                if (!_visit_move(visitor, Move(from_square, to_square)))
+                {
+                    return false;
+                }
             }
         }
 
         // Generate castling moves.
         if (from_mask & this->kings)
         {
-            for (const Move &move : this->generate_castling_moves(from_mask, to_mask))
+            if (!this->_visit_castling_moves(from_mask, to_mask, visitor))
             {
-                iter.push_back(move);
+                return false;
             }
         }
 
@@ -1941,7 +2347,7 @@ namespace chess
         Bitboard pawns = this->pawns & this->occupied_co[this->turn] & from_mask;
         if (!pawns)
         {
-            return iter;
+            return true;
         }
 
         // Generate pawn captures.
@@ -1955,14 +2361,17 @@ namespace chess
             {
                 if (square_rank(to_square) == 0 || square_rank(to_square) == 7)
                 {
-                    iter.push_back(Move(from_square, to_square, QUEEN));
-                    iter.push_back(Move(from_square, to_square, ROOK));
-                    iter.push_back(Move(from_square, to_square, BISHOP));
-                    iter.push_back(Move(from_square, to_square, KNIGHT));
+                    if (!_visit_move(visitor, Move(from_square, to_square, QUEEN)) ||
+                        !_visit_move(visitor, Move(from_square, to_square, ROOK)) ||
+                        !_visit_move(visitor, Move(from_square, to_square, BISHOP)) ||
+                        !_visit_move(visitor, Move(from_square, to_square, KNIGHT)))
+                    {
+                        return false;
+                    }
                 }
-                else
+                else if (!_visit_move(visitor, Move(from_square, to_square)))
                 {
-                    iter.push_back(Move(from_square, to_square));
+                    return false;
                 }
             }
         }
@@ -1990,14 +2399,17 @@ namespace chess
 
             if (square_rank(to_square) == 0 || square_rank(to_square) == 7)
             {
-                iter.push_back(Move(from_square, to_square, QUEEN));
-                iter.push_back(Move(from_square, to_square, ROOK));
-                iter.push_back(Move(from_square, to_square, BISHOP));
-                iter.push_back(Move(from_square, to_square, KNIGHT));
+                if (!_visit_move(visitor, Move(from_square, to_square, QUEEN)) ||
+                    !_visit_move(visitor, Move(from_square, to_square, ROOK)) ||
+                    !_visit_move(visitor, Move(from_square, to_square, BISHOP)) ||
+                    !_visit_move(visitor, Move(from_square, to_square, KNIGHT)))
+                {
+                    return false;
+                }
             }
-            else
+            else if (!_visit_move(visitor, Move(from_square, to_square)))
             {
-                iter.push_back(Move(from_square, to_square));
+                return false;
             }
         }
 
@@ -2005,31 +2417,54 @@ namespace chess
         for (Square to_square : scan_reversed(double_moves))
         {
             Square from_square = to_square + (this->turn == BLACK ? 16 : -16);
-            iter.push_back(Move(from_square, to_square));
+            if (!_visit_move(visitor, Move(from_square, to_square)))
+            {
+                return false;
+            }
         }
 
         // Generate en passant captures.
         if (this->ep_square)
         {
-            for (const Move &move : this->generate_pseudo_legal_ep(from_mask, to_mask))
+            if (!this->_visit_pseudo_legal_ep(from_mask, to_mask, visitor))
             {
-                iter.push_back(move);
+                return false;
             }
         }
-        return iter;
+        return true;
     }
 
-    std::vector<Move> Board::generate_pseudo_legal_ep(Bitboard from_mask, Bitboard to_mask) const
+    std::vector<Move> Board::generate_pseudo_legal_moves(Bitboard from_mask, Bitboard to_mask) const
     {
         std::vector<Move> iter;
+        auto collect = [&iter](const Move &move)
+        { iter.push_back(move); };
+        this->_visit_pseudo_legal_moves(from_mask, to_mask, collect);
+        return iter;
+    }
+
+    template <typename Visitor>
+    void Board::generate_pseudo_legal_moves(Bitboard from_mask, Bitboard to_mask, Visitor &&visitor) const
+    {
+        /*
+        Generates pseudo-legal moves without materializing a move list,
+        invoking *visitor* once per move. A visitor returning ``bool`` can
+        stop the generation early by returning ``false``.
+        */
+        this->_visit_pseudo_legal_moves(from_mask, to_mask, visitor);
+    }
+
+    template <typename Visitor>
+    bool Board::_visit_pseudo_legal_ep(Bitboard from_mask, Bitboard to_mask, Visitor &visitor) const
+    {
         if (!this->ep_square || !(BB_SQUARES[*this->ep_square] & to_mask))
         {
-            return iter;
+            return true;
         }
 
         if (BB_SQUARES[*this->ep_square] & this->occupied)
         {
-            return iter;
+            return true;
         }
 
         Bitboard capturers = (this->pawns & this->occupied_co[this->turn] & from_mask &
@@ -2038,23 +2473,46 @@ namespace chess
 
         for (Square capturer : scan_reversed(capturers))
         {
-            iter.push_back(Move(capturer, *this->ep_square));
+            if (!_visit_move(visitor, Move(capturer, *this->ep_square)))
+            {
+                return false;
+            }
         }
+        return true;
+    }
+
+    std::vector<Move> Board::generate_pseudo_legal_ep(Bitboard from_mask, Bitboard to_mask) const
+    {
+        std::vector<Move> iter;
+        auto collect = [&iter](const Move &move)
+        { iter.push_back(move); };
+        this->_visit_pseudo_legal_ep(from_mask, to_mask, collect);
         return iter;
     }
 
+    template <typename Visitor>
+    void Board::generate_pseudo_legal_ep(Bitboard from_mask, Bitboard to_mask, Visitor &&visitor) const
+    {
+        this->_visit_pseudo_legal_ep(from_mask, to_mask, visitor);
+    }
+
     std::vector<Move> Board::generate_pseudo_legal_captures(Bitboard from_mask, Bitboard to_mask) const
     {
         std::vector<Move> iter;
-        for (const Move &move : this->generate_pseudo_legal_moves(from_mask, to_mask & this->occupied_co[!this->turn]))
-        {
-            iter.push_back(move);
-        }
-        for (const Move &move : this->generate_pseudo_legal_ep(from_mask, to_mask))
+        auto collect = [&iter](const Move &move)
+        { iter.push_back(move); };
+        this->_visit_pseudo_legal_moves(from_mask, to_mask & this->occupied_co[!this->turn], collect);
+        this->_visit_pseudo_legal_ep(from_mask, to_mask, collect);
+        return iter;
+    }
+
+    template <typename Visitor>
+    void Board::generate_pseudo_legal_captures(Bitboard from_mask, Bitboard to_mask, Visitor &&visitor) const
+    {
+        if (this->_visit_pseudo_legal_moves(from_mask, to_mask & this->occupied_co[!this->turn], visitor))
         {
-            iter.push_back(move);
+            this->_visit_pseudo_legal_ep(from_mask, to_mask, visitor);
         }
-        return iter;
     }
 
     Bitboard Board::checkers_mask() const
@@ -2063,6 +2521,48 @@ namespace chess
         return king == std::nullopt ? BB_EMPTY : this->attackers_mask(!this->turn, *king);
     }
 
+    Bitboard Board::zobrist_hash() const
+    {
+        /*
+        Gets a 64-bit Zobrist hash of the position.
+
+        The piece placement part is maintained incrementally by
+        :func:`~chess::Board::push()` and :func:`~chess::Board::pop()`;
+        the turn, castling rights and en passant file are mixed in here.
+        */
+        Bitboard key = this->_hash_key;
+
+        Bitboard castling_rights = this->clean_castling_rights();
+        if (castling_rights & BB_H1)
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[768];
+        }
+        if (castling_rights & BB_A1)
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[769];
+        }
+        if (castling_rights & BB_H8)
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[770];
+        }
+        if (castling_rights & BB_A8)
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[771];
+        }
+
+        if (this->has_legal_en_passant())
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[772 + square_file(*this->ep_square)];
+        }
+
+        if (this->turn == WHITE)
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[780];
+        }
+
+        return key;
+    }
+
     chess::SquareSet Board::checkers() const
     {
         /*
@@ -2099,15 +2599,31 @@ namespace chess
             return false;
         }
 
+        const _LegalityContext &context = this->_legality_context();
+        bool cached = context.king == king;
+
         // If already in check, look if it is an evasion.
-        Bitboard checkers = this->attackers_mask(!this->turn, *king);
-        std::vector<Move> evasions = this->_generate_evasions(*king, checkers, BB_SQUARES[move.from_square], BB_SQUARES[move.to_square]);
-        if (checkers && std::find(std::begin(evasions), std::end(evasions), move) == std::end(evasions))
+        Bitboard checkers = cached ? context.checkers : this->attackers_mask(!this->turn, *king);
+        if (checkers)
         {
-            return true;
+            bool evades = false;
+            auto matches = [&move, &evades](const Move &evasion) -> bool
+            {
+                if (evasion == move)
+                {
+                    evades = true;
+                    return false;
+                }
+                return true;
+            };
+            this->_visit_evasions(*king, checkers, BB_SQUARES[move.from_square], BB_SQUARES[move.to_square], matches);
+            if (!evades)
+            {
+                return true;
+            }
         }
 
-        return !this->_is_safe(*king, this->_slider_blockers(*king), move);
+        return !this->_is_safe(*king, cached ? context.blockers : this->_slider_blockers(*king), move);
     }
 
     bool Board::was_into_check() const
@@ -2241,6 +2757,7 @@ namespace chess
 
     bool Board::is_game_over(bool claim_draw)
     {
+        _CHESS_STATS_SCOPE(is_game_over);
         return this->outcome(claim_draw) != std::nullopt;
     }
 
@@ -2295,7 +2812,7 @@ namespace chess
         {
             return Outcome(Termination::INSUFFICIENT_MATERIAL, std::nullopt);
         }
-        if (this->generate_legal_moves().empty())
+        if (!this->has_any_legal_move())
         {
             return Outcome(Termination::STALEMATE, std::nullopt);
         }
@@ -2326,6 +2843,27 @@ namespace chess
         return std::nullopt;
     }
 
+    bool Board::has_any_legal_move() const
+    {
+        /*
+        Checks if the side to move has at least one legal move, stopping at
+        the first one found instead of generating them all. Captures are
+        probed first.
+        */
+        bool any = false;
+        auto probe = [&any](const Move &) -> bool
+        {
+            any = true;
+            return false;
+        };
+        this->_visit_legal_moves(BB_ALL, this->occupied_co[!this->turn], probe);
+        if (!any)
+        {
+            this->_visit_legal_moves(BB_ALL, ~this->occupied_co[!this->turn], probe);
+        }
+        return any;
+    }
+
     bool Board::is_checkmate() const
     {
         /* Checks if the current position is a checkmate. */
@@ -2334,7 +2872,7 @@ namespace chess
             return false;
         }
 
-        return this->generate_legal_moves().empty();
+        return !this->has_any_legal_move();
     }
 
     bool Board::is_stalemate() const
@@ -2350,7 +2888,7 @@ namespace chess
             return false;
         }
 
-        return this->generate_legal_moves().empty();
+        return !this->has_any_legal_move();
     }
 
     bool Board::is_insufficient_material() const
@@ -2491,38 +3029,21 @@ namespace chess
         scenario, every legal move has to be tested and the entire game has to
         be replayed because there is no incremental transposition table.
         */
-        auto transposition_key = this->_transposition_key();
-
-        struct transposition_hash
-        {
-            size_t operator()(const std::tuple<Bitboard, Bitboard, Bitboard, Bitboard, Bitboard, Bitboard, Bitboard, Bitboard, Color, Bitboard, Square> &key) const
-            {
-                return std::hash<Bitboard>()(std::get<0>(key)) ^ std::hash<Bitboard>()(std::get<1>(key)) ^ std::hash<Bitboard>()(std::get<2>(key)) ^ std::hash<Bitboard>()(std::get<3>(key)) ^ std::hash<Bitboard>()(std::get<4>(key)) ^ std::hash<Bitboard>()(std::get<5>(key)) ^ std::hash<Bitboard>()(std::get<6>(key)) ^ std::hash<Bitboard>()(std::get<7>(key)) ^ std::hash<Color>()(std::get<8>(key)) ^ std::hash<Bitboard>()(std::get<9>(key)) ^ std::hash<Square>()(std::get<10>(key));
-            }
-        };
+        Bitboard transposition_key = this->zobrist_hash();
 
-        std::unordered_map<std::tuple<Bitboard, Bitboard, Bitboard, Bitboard, Bitboard, Bitboard, Bitboard, Bitboard, Color, Bitboard, Square>, int, transposition_hash> transpositions;
+        std::unordered_map<Bitboard, int> transpositions;
         ++transpositions[transposition_key];
 
-        // Count positions.
-        std::stack<Move> switchyard;
-        while (!this->move_stack.empty())
-        {
-            Move move = this->pop();
-            switchyard.push(move);
-
-            if (this->is_irreversible(move))
-            {
-                break;
-            }
-
-            ++transpositions[this->_transposition_key()];
-        }
-
-        while (!switchyard.empty())
+        // Count positions from the snapshot history, restored one at a
+        // time into a scratch board; nothing before the last irreversible
+        // move can repeat, and the live board is never mutated.
+        int size = this->_stack.size();
+        int available = std::min<int>(this->halfmove_clock, size);
+        Board scratch = Board(std::nullopt);
+        for (int i = size - 1; i >= size - available; --i)
         {
-            this->push(switchyard.top());
-            switchyard.pop();
+            this->_stack[i].restore(scratch);
+            ++transpositions[scratch.zobrist_hash()];
         }
 
         // Threefold repetition occured.
@@ -2535,7 +3056,8 @@ namespace chess
         for (const Move &move : this->generate_legal_moves())
         {
             this->push(move);
-            bool flag = transpositions.find(this->_transposition_key()) != std::end(transpositions) && transpositions.at(this->_transposition_key()) >= 2;
+            auto it = transpositions.find(this->zobrist_hash());
+            bool flag = it != std::end(transpositions) && it->second >= 2;
             this->pop();
             if (flag)
             {
@@ -2560,63 +3082,35 @@ namespace chess
         game has to be replayed because there is no incremental transposition
         table.
         */
-        // Fast check, based on occupancy only.
-        int maybe_repetitions = 1;
-        for (auto it = rbegin(this->_stack); it != rend(this->_stack); ++it)
+        if (count <= 1)
         {
-            _BoardState state = *it;
-            if (state.occupied == this->occupied)
-            {
-                ++maybe_repetitions;
-                if (maybe_repetitions >= count)
-                {
-                    break;
-                }
-            }
-        }
-        if (maybe_repetitions < count)
-        {
-            return false;
+            return true;
         }
 
-        // Check full replay.
-        auto transposition_key = this->_transposition_key();
-        std::stack<Move> switchyard;
+        // Scan the snapshot history backward, at most halfmove_clock plies
+        // (nothing before the last irreversible move can match anyway).
+        // Candidates are prefiltered by the incremental piece placement
+        // hash; only matches are restored into a scratch board to compare
+        // the full position hash, so the live board is never mutated.
+        Bitboard transposition_key = this->zobrist_hash();
+        int size = this->_stack.size();
+        int available = std::min<int>(this->halfmove_clock, size);
 
-        bool flag = false;
-        while (true)
+        Board scratch = Board(std::nullopt);
+        for (int i = size - 2; i >= size - available; i -= 2)
         {
-            if (count <= 1)
-            {
-                flag = true;
-                break;
-            }
-
-            if (this->move_stack.size() < count - 1)
-            {
-                break;
-            }
-
-            Move move = this->pop();
-            switchyard.push(move);
-
-            if (this->is_irreversible(move))
+            if (this->_stack[i].hash_key != this->_hash_key)
             {
-                break;
+                continue;
             }
-
-            if (this->_transposition_key() == transposition_key)
+            this->_stack[i].restore(scratch);
+            if (scratch.zobrist_hash() == transposition_key && --count <= 1)
             {
-                --count;
+                return true;
             }
         }
-        while (!switchyard.empty())
-        {
-            this->push(switchyard.top());
-            switchyard.pop();
-        }
 
-        return flag;
+        return false;
     }
 
     void Board::push(Move move)
@@ -2644,12 +3138,14 @@ namespace chess
             responsibility to ensure that the move is at least pseudo-legal or
             a null move.
         */
-        // Push move and remember board state.
+        _CHESS_STATS_SCOPE(push);
+
+        // Push move and remember board state. The snapshot is built in
+        // place on the stack instead of going through a temporary.
         move = this->_to_chess960(move);
-        _BoardState board_state = this->_board_state();
+        this->_stack.emplace_back(*this);
         this->castling_rights = this->clean_castling_rights(); // Before pushing stack
         this->move_stack.push_back(this->_from_chess960(this->chess960, move.from_square, move.to_square, move.promotion, move.drop));
-        this->_stack.push_back(board_state);
 
         // Reset en passant square.
         std::optional<Square> ep_square = this->ep_square;
@@ -2793,6 +3289,8 @@ namespace chess
 
         :throws: :exc:`std::out_of_range` if the move stack is empty.
         */
+        _CHESS_STATS_SCOPE(pop);
+
         if (this->move_stack.empty())
         {
             throw std::out_of_range("");
@@ -2918,13 +3416,32 @@ namespace chess
     bool Board::has_pseudo_legal_en_passant() const
     {
         /* Checks if there is a pseudo-legal en passant capture. */
-        return this->ep_square != std::nullopt && !this->generate_pseudo_legal_ep().empty();
+        if (this->ep_square == std::nullopt || (BB_SQUARES[*this->ep_square] & this->occupied))
+        {
+            return false;
+        }
+
+        return bool(this->pawns & this->occupied_co[this->turn] &
+                    BB_PAWN_ATTACKS[!this->turn][*this->ep_square] &
+                    BB_RANKS[this->turn ? 4 : 3]);
     }
 
     bool Board::has_legal_en_passant() const
     {
         /* Checks if there is a legal en passant capture. */
-        return this->ep_square != std::nullopt && !this->generate_legal_ep().empty();
+        if (!this->has_pseudo_legal_en_passant())
+        {
+            return false;
+        }
+
+        bool any = false;
+        auto probe = [&any](const Move &) -> bool
+        {
+            any = true;
+            return false;
+        };
+        this->generate_legal_ep(BB_ALL, BB_ALL, probe);
+        return any;
     }
 
     std::string Board::fen(bool shredder, _EnPassantSpec en_passant, std::optional<bool> promoted)
@@ -2962,171 +3479,386 @@ namespace chess
         return this->epd(true, en_passant, promoted) + " " + std::to_string(this->halfmove_clock) + " " + std::to_string(this->fullmove_number);
     }
 
-    void Board::set_fen(const std::string &fen)
+    void Board::set_fen(std::string_view fen)
     {
         /*
-        Parses a FEN and sets the position from it.
+        Parses a FEN and sets the position from it. The parts are parsed
+        in place without intermediate stream or container allocations, for
+        bulk ingestion together with :func:`chess::batch_process()`.
 
         :throws: :exc:`std::invalid_argument` if syntactically invalid. Use
             :func:`~chess::Board::is_valid()` to detect invalid positions.
         */
-        std::istringstream iss(fen);
-        std::deque<std::string> parts = {std::istream_iterator<std::string>(iss), {}};
+        _CHESS_STATS_SCOPE(set_fen);
 
-        // Board part.
-        std::string board_part;
-        if (!parts.empty())
+        // Split into at most 6 whitespace-separated parts.
+        std::string_view parts[6];
+        int count = 0;
+        for (size_t i = 0; i < fen.length();)
         {
-            board_part = parts.front();
-            parts.pop_front();
+            while (i < fen.length() && fen[i] == ' ')
+            {
+                ++i;
+            }
+            if (i >= fen.length())
+            {
+                break;
+            }
+            size_t begin = i;
+            while (i < fen.length() && fen[i] != ' ')
+            {
+                ++i;
+            }
+            if (count == 6)
+            {
+                throw std::invalid_argument("fen string has more parts than expected: \"" + std::string(fen) + "\"");
+            }
+            parts[count++] = fen.substr(begin, i - begin);
         }
-        else
+
+        // Board part.
+        if (!count)
         {
             throw std::invalid_argument("empty fen");
         }
+        std::string_view board_part = parts[0];
 
         // Turn.
-        std::string turn_part;
         Color turn;
-        if (!parts.empty())
+        if (count < 2 || parts[1] == "w")
         {
-            turn_part = parts.front();
-            parts.pop_front();
-
-            if (turn_part == "w")
-            {
-                turn = WHITE;
-            }
-            else if (turn_part == "b")
-            {
-                turn = BLACK;
-            }
-            else
-            {
-                throw std::invalid_argument("expected 'w' or 'b' for turn part of fen: \"" + fen + "\"");
-            }
+            turn = WHITE;
+        }
+        else if (parts[1] == "b")
+        {
+            turn = BLACK;
         }
         else
         {
-            turn = WHITE;
+            throw std::invalid_argument("expected 'w' or 'b' for turn part of fen: \"" + std::string(fen) + "\"");
         }
 
         // Validate castling part.
-        std::string castling_part;
-        if (!parts.empty())
+        std::string_view castling_part = count < 3 ? std::string_view("-") : parts[2];
+        if (!_valid_castling_fen(castling_part))
         {
-            castling_part = parts.front();
-            parts.pop_front();
+            throw std::invalid_argument("invalid castling part in fen: \"" + std::string(fen) + "\"");
+        }
 
-            if (!regex_match(castling_part, FEN_CASTLING_REGEX))
+        // En passant square.
+        std::optional<Square> ep_square;
+        if (count >= 4 && parts[3] != "-")
+        {
+            if (parts[3].length() != 2 || parts[3][0] < 'a' || parts[3][0] > 'h' || parts[3][1] < '1' || parts[3][1] > '8')
             {
-                throw std::invalid_argument("invalid castling part in fen: \"" + fen + "\"");
+                throw std::invalid_argument("invalid en passant part in fen: \"" + std::string(fen) + "\"");
             }
+            ep_square = square(parts[3][0] - 'a', parts[3][1] - '1');
         }
         else
         {
-            castling_part = "-";
+            ep_square = std::nullopt;
         }
 
-        // En passant square.
-        std::optional<std::string> ep_part;
-        std::optional<Square> ep_square;
-        if (!parts.empty())
+        // Check that the half-move part is valid.
+        int halfmove_clock = 0;
+        if (count >= 5)
         {
-            ep_part = parts.front();
-            parts.pop_front();
+            for (char c : parts[4])
+            {
+                if (c < '0' || c > '9')
+                {
+                    throw std::invalid_argument("invalid half-move clock in fen: \"" + std::string(fen) + "\"");
+                }
+                halfmove_clock = halfmove_clock * 10 + (c - '0');
+            }
+            if (parts[4].empty())
+            {
+                throw std::invalid_argument("invalid half-move clock in fen: \"" + std::string(fen) + "\"");
+            }
+        }
 
-            if (ep_part != "-")
+        // Check that the full-move number part is valid.
+        // 0 is allowed for compatibility, but later replaced with 1.
+        int fullmove_number = 1;
+        if (count >= 6)
+        {
+            fullmove_number = 0;
+            for (char c : parts[5])
             {
-                auto it = std::find(std::begin(SQUARE_NAMES), std::end(SQUARE_NAMES), ep_part);
-                if (it == std::end(SQUARE_NAMES))
+                if (c < '0' || c > '9')
                 {
-                    throw std::invalid_argument("invalid en passant part in fen: \"" + fen + "\"");
+                    throw std::invalid_argument("invalid fullmove number in fen: \"" + std::string(fen) + "\"");
                 }
-                ep_square = std::distance(SQUARE_NAMES, it);
+                fullmove_number = fullmove_number * 10 + (c - '0');
             }
-            else
+            fullmove_number = std::max(fullmove_number, 1);
+        }
+
+        // Validate the board part and set it.
+        this->_set_board_fen(std::string(board_part));
+
+        // Apply.
+        this->turn = turn;
+        this->_set_castling_fen(std::string(castling_part));
+        this->ep_square = ep_square;
+        this->halfmove_clock = halfmove_clock;
+        this->fullmove_number = fullmove_number;
+        this->clear_stack();
+    }
+
+    size_t Board::fen_to(char *buf) const
+    {
+        /*
+        Writes the FEN of the position (with the default
+        :func:`~chess::Board::fen()` formatting: X-FEN castling, legal en
+        passant, no promotion markers) into the caller-provided buffer
+        without allocating, NUL-terminates it and returns the length.
+        The buffer must hold at least 92 characters.
+        */
+        char *out = buf;
+
+        // Board part.
+        for (int rank = 7; rank >= 0; --rank)
+        {
+            int empty = 0;
+            for (int file = 0; file < 8; ++file)
             {
-                ep_square = std::nullopt;
+                Square sq = square(file, rank);
+                Bitboard mask = BB_SQUARES[sq];
+                if (!(this->occupied & mask))
+                {
+                    ++empty;
+                    continue;
+                }
+                if (empty)
+                {
+                    *out++ = '0' + empty;
+                    empty = 0;
+                }
+                char symbol = piece_symbol(*this->piece_type_at(sq));
+                *out++ = this->occupied_co[WHITE] & mask ? std::toupper(symbol) : symbol;
+            }
+            if (empty)
+            {
+                *out++ = '0' + empty;
+            }
+            if (rank)
+            {
+                *out++ = '/';
             }
         }
+
+        // Turn.
+        *out++ = ' ';
+        *out++ = this->turn == WHITE ? 'w' : 'b';
+
+        // Castling.
+        *out++ = ' ';
+        std::string castling = this->castling_xfen();
+        for (char c : castling)
+        {
+            *out++ = c;
+        }
+
+        // En passant.
+        *out++ = ' ';
+        if (this->has_legal_en_passant())
+        {
+            *out++ = 'a' + square_file(*this->ep_square);
+            *out++ = '1' + square_rank(*this->ep_square);
+        }
         else
         {
-            ep_square = std::nullopt;
+            *out++ = '-';
         }
 
-        // Check that the half-move part is valid.
-        std::string halfmove_part;
-        int halfmove_clock;
-        if (!parts.empty())
+        // Move counters.
+        for (int counter : {this->halfmove_clock, this->fullmove_number})
+        {
+            *out++ = ' ';
+            char digits[12];
+            int n = 0;
+            do
+            {
+                digits[n++] = '0' + counter % 10;
+                counter /= 10;
+            } while (counter);
+            while (n)
+            {
+                *out++ = digits[--n];
+            }
+        }
+
+        *out = '\0';
+        return out - buf;
+    }
+
+    std::vector<unsigned char> Board::to_bytes() const
+    {
+        /*
+        Packs the position into a compact binary form: a flag byte, the
+        occupancy bitboard, one nibble per occupied square for the piece
+        kind, two bytes of castling files, then the en passant square (if
+        any) and the move counters. Typically around 24-32 bytes instead
+        of a FEN string. See :func:`~chess::Board::from_bytes()`.
+        */
+        std::vector<unsigned char> data;
+        data.reserve(32);
+
+        bool has_ep = this->ep_square != std::nullopt;
+        Bitboard promoted = this->promoted & this->occupied;
+        data.push_back((this->turn == WHITE) | this->chess960 << 1 | has_ep << 2 | bool(promoted) << 3);
+
+        for (int shift = 0; shift < 64; shift += 8)
         {
-            halfmove_part = parts.front();
-            parts.pop_front();
+            data.push_back(this->occupied >> shift & 0xff);
+        }
 
-            try
+        unsigned char pending = 0;
+        bool half = false;
+        for (Square square : scan_forward(this->occupied))
+        {
+            Color color = bool(this->occupied_co[WHITE] & BB_SQUARES[square]);
+            unsigned char kind = (*this->piece_type_at(square) - 1) * 2 + color;
+            if (half)
             {
-                halfmove_clock = stoi(halfmove_part);
+                data.push_back(pending | kind << 4);
             }
-            catch (std::invalid_argument)
+            else
             {
-                throw std::invalid_argument("invalid half-move clock in fen: \"" + fen + "\"");
+                pending = kind;
             }
+            half = !half;
+        }
+        if (half)
+        {
+            data.push_back(pending);
+        }
 
-            if (halfmove_clock < 0)
+        if (promoted)
+        {
+            for (int shift = 0; shift < 64; shift += 8)
             {
-                throw std::invalid_argument("half-move clock cannot be negative: \"" + fen + "\"");
+                data.push_back(promoted >> shift & 0xff);
             }
         }
-        else
+
+        Bitboard castling_rights = this->castling_rights;
+        unsigned char white_files = 0, black_files = 0;
+        for (Square square : scan_forward(castling_rights & BB_RANK_1))
+        {
+            white_files |= 1 << square_file(square);
+        }
+        for (Square square : scan_forward(castling_rights & BB_RANK_8))
         {
-            halfmove_clock = 0;
+            black_files |= 1 << square_file(square);
         }
+        data.push_back(white_files);
+        data.push_back(black_files);
 
-        // Check that the full-move number part is valid.
-        // 0 is allowed for compatibility, but later replaced with 1.
-        std::string fullmove_part;
-        int fullmove_number;
-        if (!parts.empty())
+        if (has_ep)
         {
-            fullmove_part = parts.front();
-            parts.pop_front();
+            data.push_back(*this->ep_square);
+        }
+
+        data.push_back(this->halfmove_clock & 0xff);
+        data.push_back(this->halfmove_clock >> 8 & 0xff);
+        data.push_back(this->fullmove_number & 0xff);
+        data.push_back(this->fullmove_number >> 8 & 0xff);
 
-            try
+        return data;
+    }
+
+    void Board::set_bytes(const std::vector<unsigned char> &data)
+    {
+        /*
+        Restores a position packed by :func:`~chess::Board::to_bytes()`,
+        reusing this board.
+
+        :throws: :exc:`std::invalid_argument` if the data is malformed.
+        */
+        size_t i = 0;
+        auto need = [&data](size_t i, size_t n)
+        {
+            if (i + n > data.size())
             {
-                fullmove_number = stoi(fullmove_part);
+                throw std::invalid_argument("truncated board data");
             }
-            catch (std::invalid_argument)
+        };
+
+        need(i, 9);
+        unsigned char flags = data[i++];
+
+        Bitboard occupied = BB_EMPTY;
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            occupied |= Bitboard(data[i++]) << shift;
+        }
+
+        this->_clear_board();
+
+        int count = popcount(occupied);
+        need(i, (count + 1) / 2);
+        bool half = false;
+        for (Square square : scan_forward(occupied))
+        {
+            unsigned char kind = half ? data[i++] >> 4 : data[i] & 0xf;
+            half = !half;
+            if (kind > 11)
             {
-                throw std::invalid_argument("invalid fullmove number in fen: \"" + fen + "\"");
+                throw std::invalid_argument("invalid piece kind in board data");
             }
+            this->_set_piece_at(square, kind / 2 + 1, kind & 1);
+        }
+        if (half)
+        {
+            ++i;
+        }
 
-            if (fullmove_number < 0)
+        if (flags & 1 << 3)
+        {
+            need(i, 8);
+            Bitboard promoted = BB_EMPTY;
+            for (int shift = 0; shift < 64; shift += 8)
             {
-                throw std::invalid_argument("fullmove number cannot be negative: \"" + fen + "\"");
+                promoted |= Bitboard(data[i++]) << shift;
             }
-
-            fullmove_number = std::max(fullmove_number, 1);
+            this->promoted = promoted & this->occupied;
         }
-        else
+
+        need(i, 2);
+        unsigned char white_files = data[i++], black_files = data[i++];
+        this->castling_rights = BB_EMPTY;
+        for (int file = 0; file < 8; ++file)
         {
-            fullmove_number = 1;
+            if (white_files & 1 << file)
+            {
+                this->castling_rights |= BB_FILES[file] & BB_RANK_1;
+            }
+            if (black_files & 1 << file)
+            {
+                this->castling_rights |= BB_FILES[file] & BB_RANK_8;
+            }
         }
 
-        // All parts should be consumed now.
-        if (!parts.empty())
+        this->turn = flags & 1;
+        this->chess960 = flags & 1 << 1;
+
+        if (flags & 1 << 2)
+        {
+            need(i, 1);
+            this->ep_square = data[i++];
+        }
+        else
         {
-            throw std::invalid_argument("fen string has more parts than expected: \"" + fen + "\"");
+            this->ep_square = std::nullopt;
         }
 
-        // Validate the board part and set it.
-        this->_set_board_fen(board_part);
+        need(i, 4);
+        this->halfmove_clock = data[i] | data[i + 1] << 8;
+        this->fullmove_number = data[i + 2] | data[i + 3] << 8;
 
-        // Apply.
-        this->turn = turn;
-        this->_set_castling_fen(castling_part);
-        this->ep_square = ep_square;
-        this->halfmove_clock = halfmove_clock;
-        this->fullmove_number = fullmove_number;
         this->clear_stack();
     }
 
@@ -3154,6 +3886,17 @@ namespace chess
         this->clear_stack();
     }
 
+    void Board::reset_chess960(int scharnagl)
+    {
+        /*
+        Sets up a Chess960 starting position by index, reusing this board:
+        a table copy into the bitboards plus the scalar resets, with the
+        stack capacity preserved. Equivalent to
+        :func:`~chess::Board::set_chess960_pos()`.
+        */
+        this->set_chess960_pos(scharnagl);
+    }
+
     void Board::set_chess960_pos(int scharnagl)
     {
         BaseBoard::set_chess960_pos(scharnagl);
@@ -3464,127 +4207,122 @@ namespace chess
 
         :throws: :exc:`std::invalid_argument` if the SAN is invalid, illegal or ambiguous.
         */
+        _CHESS_STATS_SCOPE(parse_san);
+
+        Move move = Move::null();
+        switch (this->_parse_san(san, move))
+        {
+        case _ParseSanStatus::OK:
+            return move;
+        case _ParseSanStatus::AMBIGUOUS:
+            throw std::invalid_argument("ambiguous san: \"" + san + "\" in " + this->fen());
+        case _ParseSanStatus::MULTI_LEG:
+            throw std::invalid_argument("unsupported multi-leg move: \"" + san + "\"");
+        case _ParseSanStatus::MISSING_PROMOTION:
+            throw std::invalid_argument("missing promotion piece type: \"" + san + "\" in " + this->fen());
+        case _ParseSanStatus::INVALID:
+            throw std::invalid_argument("invalid san: \"" + san + "\"");
+        default:
+            throw std::invalid_argument("illegal san: \"" + san + "\" in " + this->fen());
+        }
+    }
+
+    std::optional<Move> Board::try_parse_san(const std::string &san) const
+    {
+        /*
+        Like :func:`~chess::Board::parse_san()`, but returns ``std::nullopt``
+        instead of throwing on invalid, illegal or ambiguous input. Useful on
+        hot ingestion paths where exception throws are too expensive.
+        */
+        Move move = Move::null();
+        return this->_parse_san(san, move) == _ParseSanStatus::OK ? std::optional(move) : std::nullopt;
+    }
+
+    Board::_ParseSanStatus Board::_parse_san(const std::string &san, Move &move) const
+    {
         // Castling.
-        try
+        if (san == "O-O" || san == "O-O+" || san == "O-O#" || san == "0-0" || san == "0-0+" || san == "0-0#" ||
+            san == "O-O-O" || san == "O-O-O+" || san == "O-O-O#" || san == "0-0-0" || san == "0-0-0+" || san == "0-0-0#")
         {
-            if (san == "O-O" || san == "O-O+" || san == "O-O#" || san == "0-0" || san == "0-0+" || san == "0-0#")
+            bool queenside = san.compare(0, 5, "O-O-O") == 0 || san.compare(0, 5, "0-0-0") == 0;
+            std::optional<Move> castling_move;
+            auto matches = [this, queenside, &castling_move](const Move &candidate) -> bool
             {
-                for (const Move &move : this->generate_castling_moves())
+                if (queenside ? this->is_queenside_castling(candidate) : this->is_kingside_castling(candidate))
                 {
-                    if (this->is_kingside_castling(move))
-                    {
-                        return move;
-                    }
+                    castling_move = candidate;
+                    return false;
                 }
-                throw std::out_of_range("");
-            }
-            else if (san == "O-O-O" || san == "O-O-O+" || san == "O-O-O#" || san == "0-0-0" || san == "0-0-0+" || san == "0-0-0#")
+                return true;
+            };
+            this->_visit_castling_moves(BB_ALL, BB_ALL, matches);
+            if (castling_move == std::nullopt)
             {
-                for (const Move &move : this->generate_castling_moves())
-                {
-                    if (this->is_queenside_castling(move))
-                    {
-                        return move;
-                    }
-                }
-                throw std::out_of_range("");
+                return _ParseSanStatus::ILLEGAL;
             }
-        }
-        catch (std::out_of_range)
-        {
-            throw std::invalid_argument("illegal san: \"" + san + "\" in" + this->fen());
+            move = *castling_move;
+            return _ParseSanStatus::OK;
         }
 
         // Match normal moves.
-        std::smatch match;
-        std::regex_search(san, match, SAN_REGEX);
-        if (match.empty())
+        char piece_char, promotion_char;
+        int from_file, from_rank, to_file, to_rank;
+        if (!_san_tokens(san, piece_char, from_file, from_rank, to_file, to_rank, promotion_char))
         {
             // Null moves.
             if (san == "--" || san == "Z0" || san == "0000" || san == "@@@@")
             {
-                return Move::null();
-            }
-            else if (san.find(',') != std::string::npos)
-            {
-                throw std::invalid_argument("unsupported multi-leg move: \"" + san + "\"");
-            }
-            else
-            {
-                throw std::invalid_argument("invalid san: \"" + san + "\"");
+                move = Move::null();
+                return _ParseSanStatus::OK;
             }
+            return san.find(',') != std::string::npos ? _ParseSanStatus::MULTI_LEG : _ParseSanStatus::INVALID;
         }
 
         // Get target square. Mask our own pieces to exclude castling moves.
-        auto it = std::find(std::begin(SQUARE_NAMES), std::end(SQUARE_NAMES), match[4].str());
-        if (it == std::end(SQUARE_NAMES))
-        {
-            throw std::invalid_argument("");
-        }
-        Square to_square = std::distance(SQUARE_NAMES, it);
+        Square to_square = square(to_file, to_rank);
         Bitboard to_mask = BB_SQUARES[to_square] & ~this->occupied_co[this->turn];
 
         // Get the promotion piece type.
-        std::string p = match[5].str();
-        std::optional<PieceType> promotion;
-        if (!p.empty())
-        {
-            auto it = std::find(std::begin(PIECE_SYMBOLS), std::end(PIECE_SYMBOLS), std::tolower(p.front()));
-            if (it == std::end(PIECE_SYMBOLS))
-            {
-                throw std::invalid_argument("");
-            }
-            promotion = std::distance(PIECE_SYMBOLS, it);
-        }
-        else
-        {
-            promotion = std::nullopt;
-        }
+        std::optional<PieceType> promotion = promotion_char ? _piece_type_from_symbol(promotion_char) : std::nullopt;
 
         // Filter by original square.
-        int from_file;
         Bitboard from_mask = BB_ALL;
-        if (!match[2].str().empty())
+        if (from_file >= 0)
         {
-            auto it = std::find(std::begin(FILE_NAMES), std::end(FILE_NAMES), match[2].str().front());
-            if (it == std::end(FILE_NAMES))
-            {
-                throw std::invalid_argument("");
-            }
-            from_file = std::distance(FILE_NAMES, it);
             from_mask &= BB_FILES[from_file];
         }
-        int from_rank;
-        if (!match[3].str().empty())
+        if (from_rank >= 0)
         {
-            from_rank = stoi(match[3].str()) - 1;
             from_mask &= BB_RANKS[from_rank];
         }
 
         // Filter by piece type.
-        if (!match[1].str().empty())
+        if (piece_char)
         {
-            auto it = std::find(std::begin(PIECE_SYMBOLS), std::end(PIECE_SYMBOLS), std::tolower(match[1].str().front()));
-            if (it == std::end(PIECE_SYMBOLS) || match[1].str().length() > 1)
-            {
-                throw std::invalid_argument("");
-            }
-            PieceType piece_type = std::distance(PIECE_SYMBOLS, it);
-            from_mask &= this->pieces_mask(piece_type, this->turn);
+            from_mask &= this->pieces_mask(*_piece_type_from_symbol(std::tolower(piece_char)), this->turn);
         }
-        else if (!match[2].str().empty() && !match[3].str().empty())
+        else if (from_file >= 0 && from_rank >= 0)
         {
             // Allow fully specified moves, even if they are not pawn moves,
             // including castling moves.
-            Move move = this->find_move(square(from_file, from_rank), to_square, promotion);
-            if (move.promotion == promotion)
+            Square from_square = square(from_file, from_rank);
+            std::optional<PieceType> full_promotion = promotion;
+            if (full_promotion == std::nullopt && this->pawns & BB_SQUARES[from_square] && BB_SQUARES[to_square] & BB_BACKRANKS)
             {
-                return move;
+                full_promotion = QUEEN;
             }
-            else
+
+            Move candidate = this->_from_chess960(this->chess960, from_square, to_square, full_promotion);
+            if (!this->is_legal(candidate))
             {
-                throw std::invalid_argument("missing promotion piece type: \"" + san + "\" in " + this->fen());
+                return _ParseSanStatus::ILLEGAL;
             }
+            if (candidate.promotion != promotion)
+            {
+                return _ParseSanStatus::MISSING_PROMOTION;
+            }
+            move = candidate;
+            return _ParseSanStatus::OK;
         }
         else
         {
@@ -3593,27 +4331,36 @@ namespace chess
 
         // Match legal moves.
         std::optional<Move> matched_move = std::nullopt;
-        for (const Move &move : this->generate_legal_moves(from_mask, to_mask))
+        bool ambiguous = false;
+        auto match = [promotion, &matched_move, &ambiguous](const Move &candidate) -> bool
         {
-            if (move.promotion != promotion)
+            if (candidate.promotion != promotion)
             {
-                continue;
+                return true;
             }
 
             if (matched_move)
             {
-                throw std::invalid_argument("ambiguous san: \"" + san + "\" in " + this->fen());
+                ambiguous = true;
+                return false;
             }
 
-            matched_move = move;
-        }
+            matched_move = candidate;
+            return true;
+        };
+        this->_visit_legal_moves(from_mask, to_mask, match);
 
+        if (ambiguous)
+        {
+            return _ParseSanStatus::AMBIGUOUS;
+        }
         if (!matched_move)
         {
-            throw std::invalid_argument("illegal san: \"" + san + "\" in " + this->fen());
+            return _ParseSanStatus::ILLEGAL;
         }
 
-        return *matched_move;
+        move = *matched_move;
+        return _ParseSanStatus::OK;
     }
 
     Move Board::push_san(const std::string &san)
@@ -4108,123 +4855,573 @@ namespace chess
         return this->status() == STATUS_VALID;
     }
 
+    template <typename Visitor>
+    bool Board::_visit_legal_moves(Bitboard from_mask, Bitboard to_mask, Visitor &visitor) const
+    {
+        _CHESS_STATS_SCOPE(generate_legal_moves);
+        if (this->is_variant_end())
+        {
+            return true;
+        }
+
+        const _LegalityContext &context = this->_legality_context();
+        if (context.king)
+        {
+            Square king = *context.king;
+            Bitboard blockers = context.blockers;
+            auto safe = [this, king, blockers, &visitor](const Move &move) -> bool
+            {
+                return this->_is_safe(king, blockers, move) ? _visit_move(visitor, move) : true;
+            };
+            if (context.checkers)
+            {
+                return this->_visit_evasions(king, context.checkers, from_mask, to_mask, safe);
+            }
+            else
+            {
+                return this->_visit_pseudo_legal_moves(from_mask, to_mask, safe);
+            }
+        }
+        else
+        {
+            return this->_visit_pseudo_legal_moves(from_mask, to_mask, visitor);
+        }
+    }
+
     std::vector<Move> Board::generate_legal_moves(Bitboard from_mask, Bitboard to_mask) const
     {
         std::vector<Move> iter;
+        auto collect = [&iter](const Move &move)
+        { iter.push_back(move); };
+        this->_visit_legal_moves(from_mask, to_mask, collect);
+        return iter;
+    }
+
+    template <typename Visitor>
+    void Board::generate_legal_moves(Bitboard from_mask, Bitboard to_mask, Visitor &&visitor) const
+    {
+        /*
+        Generates legal moves without materializing a move list, invoking
+        *visitor* once per move. A visitor returning ``bool`` can stop the
+        generation early by returning ``false``.
+        */
+        this->_visit_legal_moves(from_mask, to_mask, visitor);
+    }
+
+    std::vector<Move> Board::generate_legal_ep(Bitboard from_mask, Bitboard to_mask) const
+    {
+        std::vector<Move> iter;
+        auto collect = [&iter](const Move &move)
+        { iter.push_back(move); };
+        this->generate_legal_ep(from_mask, to_mask, collect);
+        return iter;
+    }
+
+    template <typename Visitor>
+    void Board::generate_legal_ep(Bitboard from_mask, Bitboard to_mask, Visitor &&visitor) const
+    {
         if (this->is_variant_end())
         {
-            return iter;
+            return;
         }
 
-        Bitboard king_mask = this->kings & this->occupied_co[this->turn];
-        if (king_mask)
+        auto filter = [this, &visitor](const Move &move) -> bool
         {
-            Square king = msb(king_mask);
-            Bitboard blockers = this->_slider_blockers(king);
-            Bitboard checkers = this->attackers_mask(!this->turn, king);
-            if (checkers)
+            return this->is_into_check(move) ? true : _visit_move(visitor, move);
+        };
+        this->_visit_pseudo_legal_ep(from_mask, to_mask, filter);
+    }
+
+    std::vector<Move> Board::generate_legal_captures(Bitboard from_mask, Bitboard to_mask) const
+    {
+        std::vector<Move> iter;
+        auto collect = [&iter](const Move &move)
+        { iter.push_back(move); };
+        this->generate_legal_captures(from_mask, to_mask, collect);
+        return iter;
+    }
+
+    template <typename Visitor>
+    void Board::generate_legal_captures(Bitboard from_mask, Bitboard to_mask, Visitor &&visitor) const
+    {
+        if (this->_visit_legal_moves(from_mask, to_mask & this->occupied_co[!this->turn], visitor))
+        {
+            this->generate_legal_ep(from_mask, to_mask, visitor);
+        }
+    }
+
+    template <typename Visitor>
+    bool Board::_visit_castling_moves(Bitboard from_mask, Bitboard to_mask, Visitor &visitor) const
+    {
+        if (this->is_variant_end())
+        {
+            return true;
+        }
+
+        Bitboard backrank = this->turn == WHITE ? BB_RANK_1 : BB_RANK_8;
+        Bitboard king = this->occupied_co[this->turn] & this->kings & ~this->promoted & backrank & from_mask;
+        king = king & -king;
+        if (!king)
+        {
+            return true;
+        }
+
+        Bitboard bb_c = BB_FILE_C & backrank;
+        Bitboard bb_d = BB_FILE_D & backrank;
+        Bitboard bb_f = BB_FILE_F & backrank;
+        Bitboard bb_g = BB_FILE_G & backrank;
+
+        for (Square candidate : scan_reversed(this->clean_castling_rights() & backrank & to_mask))
+        {
+            Bitboard rook = BB_SQUARES[candidate];
+
+            bool a_side = rook < king;
+            Bitboard king_to = a_side ? bb_c : bb_g;
+            Bitboard rook_to = a_side ? bb_d : bb_f;
+
+            Bitboard king_path = between(msb(king), msb(king_to));
+            Bitboard rook_path = between(candidate, msb(rook_to));
+
+            if (!((this->occupied ^ king ^ rook) & (king_path | rook_path | king_to | rook_to) ||
+                  this->_attacked_for_king(king_path | king, this->occupied ^ king) ||
+                  this->_attacked_for_king(king_to, this->occupied ^ king ^ rook ^ rook_to)))
             {
-                for (const Move &move : this->_generate_evasions(king, checkers, from_mask, to_mask))
+                if (!_visit_move(visitor, this->_from_chess960(this->chess960, msb(king), candidate)))
                 {
-                    if (this->_is_safe(king, blockers, move))
-                    {
-                        iter.push_back(move);
-                    }
+                    return false;
                 }
             }
+        }
+        return true;
+    }
+
+    std::vector<Move> Board::generate_castling_moves(Bitboard from_mask, Bitboard to_mask) const
+    {
+        std::vector<Move> iter;
+        auto collect = [&iter](const Move &move)
+        { iter.push_back(move); };
+        this->_visit_castling_moves(from_mask, to_mask, collect);
+        return iter;
+    }
+
+    template <typename Visitor>
+    void Board::generate_castling_moves(Bitboard from_mask, Bitboard to_mask, Visitor &&visitor) const
+    {
+        this->_visit_castling_moves(from_mask, to_mask, visitor);
+    }
+
+    bool Board::_move_gives_check(const Move &move) const
+    {
+        // Like gives_check(), but simulated on the bitboards instead of
+        // pushing the move: direct checks from the target square, plus
+        // sliders discovered by the vacated squares.
+        std::optional<Square> enemy_king = this->king(!this->turn);
+        if (enemy_king == std::nullopt)
+        {
+            return false;
+        }
+        Square king = *enemy_king;
+        Bitboard king_bb = BB_SQUARES[king];
+
+        Bitboard our_pieces = this->occupied_co[this->turn];
+        Bitboard diag_sliders = (this->bishops | this->queens) & our_pieces;
+        Bitboard line_sliders = (this->rooks | this->queens) & our_pieces;
+
+        if (move.drop)
+        {
+            Bitboard occupied = this->occupied | BB_SQUARES[move.to_square];
+            switch (*move.drop)
+            {
+            case PAWN:
+                return bool(BB_PAWN_ATTACKS[this->turn][move.to_square] & king_bb);
+            case KNIGHT:
+                return bool(BB_KNIGHT_ATTACKS[move.to_square] & king_bb);
+            case BISHOP:
+                return bool(BB_DIAG_ATTACKS[move.to_square].at(occupied) & king_bb);
+            case ROOK:
+                return bool((BB_RANK_ATTACKS[move.to_square].at(occupied) | BB_FILE_ATTACKS[move.to_square].at(occupied)) & king_bb);
+            case QUEEN:
+                return bool((BB_DIAG_ATTACKS[move.to_square].at(occupied) |
+                             BB_RANK_ATTACKS[move.to_square].at(occupied) | BB_FILE_ATTACKS[move.to_square].at(occupied)) &
+                            king_bb);
+            default:
+                return false;
+            }
+        }
+
+        Bitboard from_bb = BB_SQUARES[move.from_square];
+        Bitboard to_bb = BB_SQUARES[move.to_square];
+
+        Bitboard occupied;
+        Square piece_square = move.to_square;
+        PieceType piece_type;
+
+        if (this->is_castling(move))
+        {
+            Bitboard backrank = this->turn == WHITE ? BB_RANK_1 : BB_RANK_8;
+            bool a_side = square_file(move.to_square) < square_file(move.from_square);
+            Bitboard rook_from = this->chess960 || this->rooks & to_bb
+                                     ? to_bb
+                                     : BB_SQUARES[a_side ? msb(BB_FILE_A & backrank) : msb(BB_FILE_H & backrank)];
+            Bitboard king_to = (a_side ? BB_FILE_C : BB_FILE_G) & backrank;
+            Bitboard rook_to = (a_side ? BB_FILE_D : BB_FILE_F) & backrank;
+
+            occupied = (this->occupied ^ from_bb ^ rook_from) | king_to | rook_to;
+            piece_square = msb(rook_to);
+            piece_type = ROOK;
+            line_sliders = (line_sliders ^ (rook_from & line_sliders)) | rook_to;
+            diag_sliders &= ~rook_from;
+            from_bb |= rook_from;
+        }
+        else
+        {
+            Bitboard captured_bb = BB_EMPTY;
+            if (this->is_en_passant(move))
+            {
+                captured_bb = BB_SQUARES[*this->ep_square + (this->turn == WHITE ? -8 : 8)];
+            }
             else
             {
-                for (const Move &move : this->generate_pseudo_legal_moves(from_mask, to_mask))
+                captured_bb = this->occupied & to_bb;
+            }
+
+            occupied = (this->occupied ^ from_bb ^ captured_bb) | to_bb;
+            piece_type = move.promotion ? *move.promotion : *this->piece_type_at(move.from_square);
+        }
+
+        // Direct checks from the landing square.
+        switch (piece_type)
+        {
+        case PAWN:
+            if (BB_PAWN_ATTACKS[this->turn][piece_square] & king_bb)
+            {
+                return true;
+            }
+            break;
+        case KNIGHT:
+            if (BB_KNIGHT_ATTACKS[piece_square] & king_bb)
+            {
+                return true;
+            }
+            break;
+        case BISHOP:
+            if (BB_DIAG_ATTACKS[piece_square].at(occupied) & king_bb)
+            {
+                return true;
+            }
+            break;
+        case ROOK:
+            if ((BB_RANK_ATTACKS[piece_square].at(occupied) | BB_FILE_ATTACKS[piece_square].at(occupied)) & king_bb)
+            {
+                return true;
+            }
+            break;
+        case QUEEN:
+            if ((BB_DIAG_ATTACKS[piece_square].at(occupied) |
+                 BB_RANK_ATTACKS[piece_square].at(occupied) | BB_FILE_ATTACKS[piece_square].at(occupied)) &
+                king_bb)
+            {
+                return true;
+            }
+            break;
+        default:
+            break;
+        }
+
+        // Discovered checks through the vacated squares.
+        return bool((BB_DIAG_ATTACKS[king].at(BB_DIAG_MASKS[king] & occupied) & (diag_sliders & ~from_bb)) |
+                    ((BB_RANK_ATTACKS[king].at(BB_RANK_MASKS[king] & occupied) |
+                      BB_FILE_ATTACKS[king].at(BB_FILE_MASKS[king] & occupied)) &
+                     (line_sliders & ~from_bb)));
+    }
+
+    std::vector<MoveInfo> Board::generate_legal_moves_info(Bitboard from_mask, Bitboard to_mask) const
+    {
+        std::vector<MoveInfo> iter;
+        auto collect = [&iter](const MoveInfo &info)
+        { iter.push_back(info); };
+        this->generate_legal_moves_info(from_mask, to_mask, collect);
+        return iter;
+    }
+
+    template <typename Visitor>
+    void Board::generate_legal_moves_info(Bitboard from_mask, Bitboard to_mask, Visitor &&visitor) const
+    {
+        /*
+        Like the visitor overload of
+        :func:`~chess::Board::generate_legal_moves()`, but invokes
+        *visitor* with a :class:`~chess::MoveInfo` record carrying the
+        capture, en passant, castling and check metadata, computed from
+        the bitboards in the same pass -- no per-move push()/pop().
+        */
+        auto annotate = [this, &visitor](const Move &move) -> bool
+        {
+            MoveInfo info;
+            info.move = move;
+            info.is_en_passant = this->is_en_passant(move);
+            info.is_castling = this->is_castling(move);
+            info.piece_type = move.drop ? *move.drop : *this->piece_type_at(move.from_square);
+            if (info.is_en_passant)
+            {
+                info.captured = PAWN;
+            }
+            else if (!info.is_castling && !move.drop)
+            {
+                info.captured = this->piece_type_at(move.to_square);
+            }
+            info.is_capture = info.captured != std::nullopt;
+            info.gives_check = this->_move_gives_check(move);
+            return _visit_move(visitor, info);
+        };
+        this->_visit_legal_moves(from_mask, to_mask, annotate);
+    }
+
+    template <typename Visitor>
+    void Board::generate_captures(Visitor &&visitor) const
+    {
+        /*
+        First stage of staged generation: legal captures in MVV-LVA order
+        (most valuable victim first, cheapest attacker first), finishing
+        with en passant. When in check, all capturing evasions are yielded
+        instead. A visitor returning ``bool`` can stop early.
+        */
+        if (this->is_variant_end())
+        {
+            return;
+        }
+
+        Bitboard king_mask = this->kings & this->occupied_co[this->turn];
+        if (!king_mask)
+        {
+            if (this->_visit_pseudo_legal_moves(BB_ALL, this->occupied_co[!this->turn], visitor))
+            {
+                this->_visit_pseudo_legal_ep(BB_ALL, BB_ALL, visitor);
+            }
+            return;
+        }
+
+        Square king = msb(king_mask);
+        Bitboard blockers = this->_slider_blockers(king);
+        Bitboard checkers = this->attackers_mask(!this->turn, king);
+        auto safe = [this, king, blockers, &visitor](const Move &move) -> bool
+        {
+            return this->_is_safe(king, blockers, move) ? _visit_move(visitor, move) : true;
+        };
+
+        if (checkers)
+        {
+            this->_visit_evasions(king, checkers, BB_ALL, this->occupied_co[!this->turn] | (this->ep_square ? BB_SQUARES[*this->ep_square] : BB_EMPTY), safe);
+            return;
+        }
+
+        const PieceType victims[] = {QUEEN, ROOK, BISHOP, KNIGHT, PAWN};
+        const PieceType attackers[] = {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING};
+        for (PieceType victim : victims)
+        {
+            Bitboard victim_mask = this->pieces_mask(victim, !this->turn);
+            if (!victim_mask)
+            {
+                continue;
+            }
+            for (PieceType attacker : attackers)
+            {
+                Bitboard attacker_mask = this->pieces_mask(attacker, this->turn);
+                if (attacker_mask && !this->_visit_pseudo_legal_moves(attacker_mask, victim_mask, safe))
                 {
-                    if (this->_is_safe(king, blockers, move))
-                    {
-                        iter.push_back(move);
-                    }
+                    return;
                 }
             }
         }
-        else
+
+        this->_visit_pseudo_legal_ep(BB_ALL, BB_ALL, safe);
+    }
+
+    template <typename Visitor>
+    void Board::generate_checks(Visitor &&visitor) const
+    {
+        /*
+        Second stage of staged generation: quiet moves that give direct
+        check against the enemy king, detected with bitboard masks around
+        it rather than per-move push()/pop(). Discovered checks are left
+        to the quiet stage. Yields nothing while in check (evasions come
+        from the other stages).
+        */
+        if (this->is_variant_end())
+        {
+            return;
+        }
+
+        Bitboard king_mask = this->kings & this->occupied_co[this->turn];
+        if (!king_mask)
+        {
+            return;
+        }
+        Square king = msb(king_mask);
+        if (this->attackers_mask(!this->turn, king))
+        {
+            return;
+        }
+
+        std::optional<Square> enemy_king = this->king(!this->turn);
+        if (enemy_king == std::nullopt)
+        {
+            return;
+        }
+
+        Bitboard blockers = this->_slider_blockers(king);
+        auto safe = [this, king, blockers, &visitor](const Move &move) -> bool
+        {
+            return this->_is_safe(king, blockers, move) ? _visit_move(visitor, move) : true;
+        };
+
+        Bitboard quiet = ~this->occupied;
+        // En passant is a capture and belongs to the previous stage, even
+        // though the target square is empty.
+        Bitboard pawn_quiet = quiet & ~(this->ep_square ? BB_SQUARES[*this->ep_square] : BB_EMPTY);
+        Bitboard diag = BB_DIAG_ATTACKS[*enemy_king].at(BB_DIAG_MASKS[*enemy_king] & this->occupied);
+        Bitboard line = (BB_RANK_ATTACKS[*enemy_king].at(BB_RANK_MASKS[*enemy_king] & this->occupied) |
+                         BB_FILE_ATTACKS[*enemy_king].at(BB_FILE_MASKS[*enemy_king] & this->occupied));
+
+        const std::tuple<PieceType, Bitboard> stages[] = {
+            {PAWN, BB_PAWN_ATTACKS[!this->turn][*enemy_king] & pawn_quiet},
+            {KNIGHT, BB_KNIGHT_ATTACKS[*enemy_king] & quiet},
+            {BISHOP, diag & quiet},
+            {ROOK, line & quiet},
+            {QUEEN, (diag | line) & quiet},
+        };
+        for (auto [piece_type, targets] : stages)
         {
-            for (const Move &move : this->generate_pseudo_legal_moves(from_mask, to_mask))
+            Bitboard from_mask = this->pieces_mask(piece_type, this->turn);
+            if (from_mask && !this->_visit_pseudo_legal_moves(from_mask, targets, safe))
             {
-                iter.push_back(move);
+                return;
             }
         }
-        return iter;
     }
 
-    std::vector<Move> Board::generate_legal_ep(Bitboard from_mask, Bitboard to_mask) const
+    template <typename Visitor>
+    void Board::generate_quiets(Visitor &&visitor) const
     {
-        std::vector<Move> iter;
+        /*
+        Third stage of staged generation: the remaining quiet legal moves,
+        i.e. everything :func:`~chess::Board::generate_captures()` and
+        :func:`~chess::Board::generate_checks()` did not yield. When in
+        check, all non-capturing evasions are yielded.
+        */
         if (this->is_variant_end())
         {
-            return iter;
+            return;
         }
 
-        for (const Move &move : this->generate_pseudo_legal_ep(from_mask, to_mask))
+        Bitboard ep_mask = this->ep_square ? BB_SQUARES[*this->ep_square] : BB_EMPTY;
+
+        Bitboard king_mask = this->kings & this->occupied_co[this->turn];
+        if (!king_mask)
         {
-            if (!this->is_into_check(move))
+            // The en passant square is only masked off for pawns: other
+            // pieces may quietly move onto it.
+            if (this->_visit_pseudo_legal_moves(~this->pawns, ~this->occupied_co[!this->turn], visitor))
             {
-                iter.push_back(move);
+                this->_visit_pseudo_legal_moves(this->pawns, ~this->occupied_co[!this->turn] & ~ep_mask, visitor);
             }
+            return;
         }
-        return iter;
-    }
 
-    std::vector<Move> Board::generate_legal_captures(Bitboard from_mask, Bitboard to_mask) const
-    {
-        std::vector<Move> iter;
-        for (const Move &move : this->generate_legal_moves(from_mask, to_mask & this->occupied_co[!this->turn]))
+        Square king = msb(king_mask);
+        Bitboard blockers = this->_slider_blockers(king);
+        Bitboard checkers = this->attackers_mask(!this->turn, king);
+        auto safe = [this, king, blockers, &visitor](const Move &move) -> bool
+        {
+            return this->_is_safe(king, blockers, move) ? _visit_move(visitor, move) : true;
+        };
+
+        if (checkers)
         {
-            iter.push_back(move);
+            this->_visit_evasions(king, checkers, BB_ALL, ~this->occupied_co[!this->turn] & ~ep_mask, safe);
+            return;
         }
-        for (const Move &move : this->generate_legal_ep(from_mask, to_mask))
+
+        std::optional<Square> enemy_king = this->king(!this->turn);
+        Bitboard diag = BB_EMPTY, line = BB_EMPTY;
+        if (enemy_king)
         {
-            iter.push_back(move);
+            diag = BB_DIAG_ATTACKS[*enemy_king].at(BB_DIAG_MASKS[*enemy_king] & this->occupied);
+            line = (BB_RANK_ATTACKS[*enemy_king].at(BB_RANK_MASKS[*enemy_king] & this->occupied) |
+                    BB_FILE_ATTACKS[*enemy_king].at(BB_FILE_MASKS[*enemy_king] & this->occupied));
+        }
+
+        Bitboard quiet = ~this->occupied_co[!this->turn];
+        const std::tuple<PieceType, Bitboard> stages[] = {
+            {PAWN, enemy_king ? BB_PAWN_ATTACKS[!this->turn][*enemy_king] : BB_EMPTY},
+            {KNIGHT, enemy_king ? BB_KNIGHT_ATTACKS[*enemy_king] : BB_EMPTY},
+            {BISHOP, diag},
+            {ROOK, line},
+            {QUEEN, diag | line},
+            {KING, BB_EMPTY},
+        };
+        for (auto [piece_type, targets] : stages)
+        {
+            Bitboard from_mask = this->pieces_mask(piece_type, this->turn);
+            Bitboard to_mask = quiet & ~(targets & ~this->occupied);
+            if (piece_type == PAWN)
+            {
+                // The en passant square is only masked off for pawns: other
+                // pieces may quietly move onto it.
+                to_mask &= ~ep_mask;
+            }
+            if (from_mask && !this->_visit_pseudo_legal_moves(from_mask, to_mask, safe))
+            {
+                return;
+            }
         }
-        return iter;
     }
 
-    std::vector<Move> Board::generate_castling_moves(Bitboard from_mask, Bitboard to_mask) const
+    unsigned long long Board::perft(int depth)
     {
-        std::vector<Move> iter;
-        if (this->is_variant_end())
+        /*
+        Counts the leaf nodes of the legal move tree up to *depth*
+        half-moves. Uses bulk counting at the horizon: the last ply is
+        counted during generation without pushing the moves.
+        */
+        if (depth <= 0)
         {
-            return iter;
+            return 1;
         }
 
-        Bitboard backrank = this->turn == WHITE ? BB_RANK_1 : BB_RANK_8;
-        Bitboard king = this->occupied_co[this->turn] & this->kings & ~this->promoted & backrank & from_mask;
-        king = king & -king;
-        if (!king)
+        if (depth == 1)
         {
-            return iter;
+            unsigned long long nodes = 0;
+            auto count = [&nodes](const Move &)
+            { ++nodes; };
+            this->_visit_legal_moves(BB_ALL, BB_ALL, count);
+            return nodes;
         }
 
-        Bitboard bb_c = BB_FILE_C & backrank;
-        Bitboard bb_d = BB_FILE_D & backrank;
-        Bitboard bb_f = BB_FILE_F & backrank;
-        Bitboard bb_g = BB_FILE_G & backrank;
-
-        for (Square candidate : scan_reversed(this->clean_castling_rights() & backrank & to_mask))
+        unsigned long long nodes = 0;
+        for (const Move &move : this->generate_legal_moves())
         {
-            Bitboard rook = BB_SQUARES[candidate];
-
-            bool a_side = rook < king;
-            Bitboard king_to = a_side ? bb_c : bb_g;
-            Bitboard rook_to = a_side ? bb_d : bb_f;
-
-            Bitboard king_path = between(msb(king), msb(king_to));
-            Bitboard rook_path = between(candidate, msb(rook_to));
+            this->push(move);
+            nodes += this->perft(depth - 1);
+            this->pop();
+        }
+        return nodes;
+    }
 
-            if (!((this->occupied ^ king ^ rook) & (king_path | rook_path | king_to | rook_to) ||
-                  this->_attacked_for_king(king_path | king, this->occupied ^ king) ||
-                  this->_attacked_for_king(king_to, this->occupied ^ king ^ rook ^ rook_to)))
-            {
-                iter.push_back(this->_from_chess960(this->chess960, msb(king), candidate));
-            }
+    std::vector<std::tuple<Move, unsigned long long>> Board::perft_divide(int depth)
+    {
+        /*
+        Like :func:`~chess::Board::perft()`, but returns the node count
+        below each root move, for comparing against another engine's
+        divide output when debugging move generation.
+        */
+        std::vector<std::tuple<Move, unsigned long long>> divide;
+        for (const Move &move : this->generate_legal_moves())
+        {
+            this->push(move);
+            divide.push_back({move, this->perft(depth - 1)});
+            this->pop();
         }
-        return iter;
+        return divide;
     }
 
     bool Board::operator==(const Board &board) const
@@ -4281,8 +5478,7 @@ namespace chess
         Defaults to copying the entire move stack. Alternatively, *stack* can
         be ``false``, or an integer to copy a limited number of moves.
         */
-        BaseBoard board_copy = BaseBoard::copy();
-        Board board = Board(STARTING_FEN, this->chess960);
+        Board board = Board(std::nullopt, this->chess960);
 
         board.pawns = this->pawns;
         board.knights = this->knights;
@@ -4295,6 +5491,7 @@ namespace chess
         board.occupied_co[BLACK] = this->occupied_co[BLACK];
         board.occupied = this->occupied;
         board.promoted = this->promoted;
+        board._hash_key = this->_hash_key;
 
         board.ep_square = this->ep_square;
         board.castling_rights = this->castling_rights;
@@ -4330,6 +5527,17 @@ namespace chess
         return {board, board.set_epd(epd)};
     }
 
+    Board Board::from_bytes(const std::vector<unsigned char> &data)
+    {
+        /*
+        Creates a new board from a position packed by
+        :func:`~chess::Board::to_bytes()`.
+        */
+        Board board = Board::empty();
+        board.set_bytes(data);
+        return board;
+    }
+
     Board Board::from_chess960_pos(int scharnagl)
     {
         Board board = Board::empty(true);
@@ -4339,7 +5547,7 @@ namespace chess
 
     bool Board::_is_halfmoves(int n) const
     {
-        return this->halfmove_clock >= n && !this->generate_legal_moves().empty();
+        return this->halfmove_clock >= n && this->has_any_legal_move();
     }
 
     _BoardState Board::_board_state() const
@@ -4359,7 +5567,7 @@ namespace chess
             return;
         }
 
-        if (!regex_match(castling_fen, FEN_CASTLING_REGEX))
+        if (!_valid_castling_fen(castling_fen))
         {
             throw std::invalid_argument("invalid castling fen: \"" + castling_fen + "\"");
         }
@@ -4960,6 +6168,38 @@ namespace chess
         return false;
     }
 
+    const Board::_LegalityContext &Board::_legality_context() const
+    {
+        if (this->_legality_cache && this->_legality_cache->hash_key == this->_hash_key &&
+            this->_legality_cache->occupied == this->occupied && this->_legality_cache->turn == this->turn)
+        {
+            return *this->_legality_cache;
+        }
+
+        _LegalityContext context;
+        context.hash_key = this->_hash_key;
+        context.occupied = this->occupied;
+        context.turn = this->turn;
+
+        Bitboard king_mask = this->kings & this->occupied_co[this->turn];
+        if (king_mask)
+        {
+            Square king = msb(king_mask);
+            context.king = king;
+            context.blockers = this->_slider_blockers(king);
+            context.checkers = this->attackers_mask(!this->turn, king);
+        }
+        else
+        {
+            context.king = std::nullopt;
+            context.blockers = BB_EMPTY;
+            context.checkers = BB_EMPTY;
+        }
+
+        this->_legality_cache = context;
+        return *this->_legality_cache;
+    }
+
     Bitboard Board::_slider_blockers(Square king) const
     {
         Bitboard rooks_and_queens = this->rooks | this->queens;
@@ -5010,9 +6250,9 @@ namespace chess
         }
     }
 
-    std::vector<Move> Board::_generate_evasions(Square king, Bitboard checkers, Bitboard from_mask, Bitboard to_mask) const
+    template <typename Visitor>
+    bool Board::_visit_evasions(Square king, Bitboard checkers, Bitboard from_mask, Bitboard to_mask, Visitor &visitor) const
     {
-        std::vector<Move> iter;
         Bitboard sliders = checkers & (this->bishops | this->rooks | this->queens);
 
         Bitboard attacked = 0;
@@ -5025,7 +6265,10 @@ namespace chess
         {
             for (Square to_square : scan_reversed(BB_KING_ATTACKS[king] & ~this->occupied_co[this->turn] & ~attacked & to_mask))
             {
-                iter.push_back(Move(king, to_square));
+                if (!_visit_move(visitor, Move(king, to_square)))
+                {
+                    return false;
+                }
             }
         }
 
@@ -5035,9 +6278,9 @@ namespace chess
             // Capture or block a single checker.
             Bitboard target = between(king, checker) | checkers;
 
-            for (const Move &move : this->generate_pseudo_legal_moves(~this->kings & from_mask, target & to_mask))
+            if (!this->_visit_pseudo_legal_moves(~this->kings & from_mask, target & to_mask, visitor))
             {
-                iter.push_back(move);
+                return false;
             }
 
             // Capture the checking pawn en passant (but avoid yielding
@@ -5047,13 +6290,22 @@ namespace chess
                 Square last_double = *this->ep_square + (this->turn == WHITE ? -8 : 8);
                 if (last_double == checker)
                 {
-                    for (const Move &move : this->generate_pseudo_legal_ep(from_mask, to_mask))
+                    if (!this->_visit_pseudo_legal_ep(from_mask, to_mask, visitor))
                     {
-                        iter.push_back(move);
+                        return false;
                     }
                 }
             }
         }
+        return true;
+    }
+
+    std::vector<Move> Board::_generate_evasions(Square king, Bitboard checkers, Bitboard from_mask, Bitboard to_mask) const
+    {
+        std::vector<Move> iter;
+        auto collect = [&iter](const Move &move)
+        { iter.push_back(move); };
+        this->_visit_evasions(king, checkers, from_mask, to_mask, collect);
         return iter;
     }
 
@@ -5150,40 +6402,317 @@ namespace chess
         return os;
     }
 
+    thread_local int _task_pool_worker = -1;
+
+    TaskPool::TaskPool(int threads)
+    {
+        /* Starts the pool; *threads* defaults to the hardware concurrency. */
+        if (threads <= 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        this->_pending = 0;
+        this->_stop = false;
+        for (int i = 0; i < threads; ++i)
+        {
+            this->_workers.push_back(std::make_unique<_Worker>());
+        }
+        for (int i = 0; i < threads; ++i)
+        {
+            this->_threads.emplace_back(&TaskPool::_run, this, i);
+        }
+    }
+
+    TaskPool::~TaskPool()
+    {
+        this->wait();
+        this->_stop = true;
+        this->_work_ready.notify_all();
+        for (std::thread &thread : this->_threads)
+        {
+            thread.join();
+        }
+    }
+
+    int TaskPool::size() const
+    {
+        return this->_threads.size();
+    }
+
+    void TaskPool::submit(std::function<void()> task)
+    {
+        /*
+        Queues a task. Safe to call from inside a running task, in which
+        case the task lands on the calling worker's own deque.
+        */
+        static std::atomic<unsigned> round_robin{0};
+        int worker = _task_pool_worker >= 0 && _task_pool_worker < (int)this->_workers.size()
+                         ? _task_pool_worker
+                         : round_robin++ % this->_workers.size();
+        ++this->_pending;
+        {
+            std::lock_guard<std::mutex> lock(this->_workers[worker]->mutex);
+            this->_workers[worker]->tasks.push_back(std::move(task));
+        }
+        this->_work_ready.notify_one();
+    }
+
+    bool TaskPool::_try_run(int worker)
+    {
+        std::function<void()> task;
+
+        // Newest-first from the own deque, then steal oldest-first.
+        for (int i = 0; i < (int)this->_workers.size(); ++i)
+        {
+            _Worker &victim = *this->_workers[(worker + i) % this->_workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                if (i == 0)
+                {
+                    task = std::move(victim.tasks.back());
+                    victim.tasks.pop_back();
+                }
+                else
+                {
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                }
+                break;
+            }
+        }
+
+        if (!task)
+        {
+            return false;
+        }
+
+        task();
+        if (--this->_pending == 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->_mutex);
+            }
+            this->_all_done.notify_all();
+        }
+        return true;
+    }
+
+    void TaskPool::_run(int worker)
+    {
+        _task_pool_worker = worker;
+        while (true)
+        {
+            if (this->_try_run(worker))
+            {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            if (this->_stop)
+            {
+                return;
+            }
+            this->_work_ready.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+
+    void TaskPool::wait()
+    {
+        /* Blocks until every submitted task has finished. */
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_all_done.wait(lock, [this]
+                             { return this->_pending.load() == 0; });
+    }
+
+    unsigned long long parallel_perft(const Board &board, int depth, int threads)
+    {
+        /*
+        Like :func:`~chess::Board::perft()`, but splits the root moves
+        across a work-stealing :class:`~chess::TaskPool`. Each task runs
+        on its own board obtained via the allocation-free copy path.
+        */
+        if (depth <= 1)
+        {
+            Board root = board.copy(false);
+            return root.perft(depth);
+        }
+
+        TaskPool pool(threads);
+        std::atomic<unsigned long long> nodes{0};
+
+        for (const Move &move : board.generate_legal_moves())
+        {
+            pool.submit([&board, &nodes, move, depth]
+                        {
+                            Board worker_board = board.copy(false);
+                            worker_board.reserve_plies(depth);
+                            worker_board.push(move);
+                            nodes += worker_board.perft(depth - 1);
+                        });
+        }
+
+        pool.wait();
+        return nodes;
+    }
+
+    BoardPool::BoardPool(int size)
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            this->_boards.push_back(std::make_unique<Board>());
+            this->_free.push_back(this->_boards.back().get());
+        }
+    }
+
+    Board *BoardPool::acquire()
+    {
+        /*
+        Takes a board out of the pool (creating one if none is free),
+        reset to the starting position. Return it with
+        :func:`~chess::BoardPool::release()`.
+        */
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            if (!this->_free.empty())
+            {
+                Board *board = this->_free.back();
+                this->_free.pop_back();
+                board->reset();
+                return board;
+            }
+        }
+
+        std::unique_ptr<Board> board = std::make_unique<Board>();
+        Board *raw = board.get();
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_boards.push_back(std::move(board));
+        return raw;
+    }
+
+    void BoardPool::release(Board *board)
+    {
+        /* Returns a board to the pool. The stacks keep their capacity. */
+        board->clear_stack();
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_free.push_back(board);
+    }
+
+    size_t BoardPool::size()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_boards.size();
+    }
+
+    template <typename F>
+    void batch_process(const std::vector<std::string> &fens, F &&fn, int threads)
+    {
+        /*
+        Shards *fens* across a pool of worker threads and invokes
+        ``fn(index, board)`` for every FEN that parses, on a thread-local
+        :class:`~chess::Board` that is reused via
+        :func:`~chess::Board::set_fen()` instead of being reconstructed.
+        FENs that fail to parse are invoked as ``fn(index, nullptr)``.
+
+        *threads* defaults to the hardware concurrency. *fn* runs
+        concurrently, so it must only touch state sharded by *index*.
+        */
+        if (threads <= 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = std::min<size_t>(threads, fens.size());
+
+        auto worker = [&fens, &fn](size_t begin, size_t end)
+        {
+            Board board = Board(std::nullopt);
+            for (size_t i = begin; i < end; ++i)
+            {
+                try
+                {
+                    board.set_fen(fens[i]);
+                }
+                catch (const std::invalid_argument &)
+                {
+                    fn(i, (Board *)nullptr);
+                    continue;
+                }
+                fn(i, &board);
+            }
+        };
+
+        if (threads <= 1)
+        {
+            worker(0, fens.size());
+            return;
+        }
+
+        std::vector<std::thread> pool;
+        size_t chunk = (fens.size() + threads - 1) / threads;
+        for (size_t begin = 0; begin < fens.size(); begin += chunk)
+        {
+            pool.emplace_back(worker, begin, std::min(begin + chunk, fens.size()));
+        }
+        for (std::thread &thread : pool)
+        {
+            thread.join();
+        }
+    }
+
     PseudoLegalMoveGenerator::PseudoLegalMoveGenerator(const Board &board)
     {
-        this->_board = board;
-        this->_iter = this->_board.generate_pseudo_legal_moves();
+        this->_board = &board;
+    }
+
+    const std::vector<Move> &PseudoLegalMoveGenerator::_moves() const
+    {
+        if (this->_iter == std::nullopt)
+        {
+            this->_iter = this->_board->generate_pseudo_legal_moves();
+        }
+        return *this->_iter;
     }
 
     PseudoLegalMoveGenerator::operator bool() const
     {
-        return !this->_iter.empty();
+        if (this->_iter)
+        {
+            return !this->_iter->empty();
+        }
+
+        bool any = false;
+        auto probe = [&any](const Move &) -> bool
+        {
+            any = true;
+            return false;
+        };
+        this->_board->generate_pseudo_legal_moves(BB_ALL, BB_ALL, probe);
+        return any;
     }
 
     int PseudoLegalMoveGenerator::count() const
     {
-        return this->_iter.size();
+        return this->_moves().size();
     }
 
-    auto PseudoLegalMoveGenerator::begin() const
+    std::vector<Move>::const_iterator PseudoLegalMoveGenerator::begin() const
     {
-        return std::begin(this->_iter);
+        return std::begin(this->_moves());
     }
 
-    auto PseudoLegalMoveGenerator::end() const
+    std::vector<Move>::const_iterator PseudoLegalMoveGenerator::end() const
     {
-        return std::end(this->_iter);
+        return std::end(this->_moves());
     }
 
     Board PseudoLegalMoveGenerator::get_board() const
     {
-        return this->_board;
+        return *this->_board;
     }
 
     PseudoLegalMoveGenerator::operator std::vector<Move>() const
     {
-        return this->_iter;
+        return this->_moves();
     }
 
     std::ostream &operator<<(std::ostream &os, PseudoLegalMoveGenerator pseudo_legal_move_generator)
@@ -5214,38 +6743,58 @@ namespace chess
 
     LegalMoveGenerator::LegalMoveGenerator(const Board &board)
     {
-        this->_board = board;
-        this->_iter = board.generate_legal_moves();
+        this->_board = &board;
+    }
+
+    const std::vector<Move> &LegalMoveGenerator::_moves() const
+    {
+        if (this->_iter == std::nullopt)
+        {
+            this->_iter = this->_board->generate_legal_moves();
+        }
+        return *this->_iter;
     }
 
     LegalMoveGenerator::operator bool() const
     {
-        return !this->_iter.empty();
+        if (this->_iter)
+        {
+            return !this->_iter->empty();
+        }
+
+        bool any = false;
+        auto probe = [&any](const Move &) -> bool
+        {
+            any = true;
+            return false;
+        };
+        this->_board->generate_legal_moves(BB_ALL, BB_ALL, probe);
+        return any;
     }
 
     int LegalMoveGenerator::count() const
     {
-        return this->_iter.size();
+        return this->_moves().size();
     }
 
-    auto LegalMoveGenerator::begin() const
+    std::vector<Move>::const_iterator LegalMoveGenerator::begin() const
     {
-        return std::begin(this->_iter);
+        return std::begin(this->_moves());
     }
 
-    auto LegalMoveGenerator::end() const
+    std::vector<Move>::const_iterator LegalMoveGenerator::end() const
     {
-        return std::end(this->_iter);
+        return std::end(this->_moves());
     }
 
     Board LegalMoveGenerator::get_board() const
     {
-        return this->_board;
+        return *this->_board;
     }
 
     LegalMoveGenerator::operator std::vector<Move>() const
     {
-        return this->_iter;
+        return this->_moves();
     }
 
     std::ostream &operator<<(std::ostream &os, LegalMoveGenerator legal_move_generator)
@@ -5265,7 +6814,6 @@ namespace chess
         try
         {
             this->_mask = std::get<Bitboard>(squares) & BB_ALL;
-            this->_iter = scan_forward(this->_mask);
             return;
         }
         catch (std::bad_variant_access)
@@ -5293,14 +6841,14 @@ namespace chess
 
     // Set
 
-    std::vector<Square>::const_iterator SquareSet::begin() const
+    _ScanForward::iterator SquareSet::begin() const
     {
-        return std::begin(this->_iter);
+        return _ScanForward(this->_mask).begin();
     }
 
-    std::vector<Square>::const_iterator SquareSet::end() const
+    _ScanForward::iterator SquareSet::end() const
     {
-        return std::end(this->_iter);
+        return _ScanForward(this->_mask).end();
     }
 
     size_t SquareSet::size() const
@@ -5314,14 +6862,12 @@ namespace chess
     {
         /* Adds a square to the set. */
         this->_mask |= BB_SQUARES[square];
-        this->_iter = scan_forward(this->_mask);
     }
 
     void SquareSet::discard(Square square)
     {
         /* Discards a square from the set. */
         this->_mask &= ~BB_SQUARES[square];
-        this->_iter = scan_forward(this->_mask);
     }
 
     // frozenset
@@ -5410,7 +6956,6 @@ namespace chess
     SquareSet SquareSet::operator|=(const IntoSquareSet &other)
     {
         this->_mask |= SquareSet(other)._mask;
-        this->_iter = scan_forward(this->_mask);
         return *this;
     }
 
@@ -5425,7 +6970,6 @@ namespace chess
     SquareSet SquareSet::operator&=(const IntoSquareSet &other)
     {
         this->_mask &= SquareSet(other)._mask;
-        this->_iter = scan_forward(this->_mask);
         return *this;
     }
 
@@ -5437,7 +6981,6 @@ namespace chess
     SquareSet SquareSet::operator-=(const IntoSquareSet &other)
     {
         this->_mask &= ~SquareSet(other)._mask;
-        this->_iter = scan_forward(this->_mask);
         return *this;
     }
 
@@ -5449,7 +6992,6 @@ namespace chess
     SquareSet SquareSet::operator^=(const IntoSquareSet &other)
     {
         this->_mask ^= SquareSet(other)._mask;
-        this->_iter = scan_forward(this->_mask);
         return *this;
     }
 
@@ -5464,7 +7006,6 @@ namespace chess
         if (this->_mask & mask)
         {
             this->_mask ^= mask;
-            this->_iter = scan_forward(this->_mask);
         }
         else
         {
@@ -5486,7 +7027,6 @@ namespace chess
 
         Square square = lsb(this->_mask);
         this->_mask &= (this->_mask - 1);
-        this->_iter = scan_forward(this->_mask);
         return square;
     }
 
@@ -5494,7 +7034,6 @@ namespace chess
     {
         /* Removes all elements from this set. */
         this->_mask = BB_EMPTY;
-        this->_iter = scan_forward(this->_mask);
     }
 
     // SquareSet
@@ -5555,14 +7094,12 @@ namespace chess
     SquareSet SquareSet::operator<<=(int shift)
     {
         this->_mask = (this->_mask << shift) & BB_ALL;
-        this->_iter = scan_forward(this->_mask);
         return *this;
     }
 
     SquareSet SquareSet::operator>>=(int shift)
     {
         this->_mask >>= shift;
-        this->_iter = scan_forward(this->_mask);
         return *this;
     }
 
@@ -5605,7 +7142,7 @@ namespace chess
 
     SquareSet::operator std::vector<Square>() const
     {
-        return this->_iter;
+        return scan_forward(this->_mask);
     }
 
     SquareSet SquareSet::ray(Square a, Square b)
@@ -10,6 +10,7 @@ and XBoard/UCI engine communication.
 */
 
 #include <string>
+#include <cstring>
 #include <unordered_map>
 #include <stdexcept>
 #include <limits>
@@ -27,6 +28,14 @@ and XBoard/UCI engine communication.
 #include <variant>
 #include <array>
 #include <iterator>
+#include <string_view>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
 
 namespace chess
 {
@@ -50,6 +59,8 @@ namespace chess
 
     char piece_symbol(PieceType);
 
+    std::optional<PieceType> _piece_type_from_symbol(char);
+
     std::string piece_name(PieceType);
 
     const std::unordered_map<char, std::string> UNICODE_PIECE_SYMBOLS = {
@@ -168,7 +179,7 @@ namespace chess
     std::ostream &operator<<(std::ostream &, const Outcome &);
 
     typedef int Square;
-    const Square SQUARES[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63}, A1 = 0, B1 = 1, C1 = 2, D1 = 3, E1 = 4, F1 = 5, G1 = 6, H1 = 7, A2 = 8, B2 = 9, C2 = 10, D2 = 11, E2 = 12, F2 = 13, G2 = 14, H2 = 15, A3 = 16, B3 = 17, C3 = 18, D3 = 19, E3 = 20, F3 = 21, G3 = 22, H3 = 23, A4 = 24, B4 = 25, C4 = 26, D4 = 27, E4 = 28, F4 = 29, G4 = 30, H4 = 31, A5 = 32, B5 = 33, C5 = 34, D5 = 35, E5 = 36, F5 = 37, G5 = 38, H5 = 39, A6 = 40, B6 = 41, C6 = 42, D6 = 43, E6 = 44, F6 = 45, G6 = 46, H6 = 47, A7 = 48, B7 = 49, C7 = 50, D7 = 51, E7 = 52, F7 = 53, G7 = 54, H7 = 55, A8 = 56, B8 = 57, C8 = 58, D8 = 59, E8 = 60, F8 = 61, G8 = 62, H8 = 63;
+    constexpr Square SQUARES[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63}, A1 = 0, B1 = 1, C1 = 2, D1 = 3, E1 = 4, F1 = 5, G1 = 6, H1 = 7, A2 = 8, B2 = 9, C2 = 10, D2 = 11, E2 = 12, F2 = 13, G2 = 14, H2 = 15, A3 = 16, B3 = 17, C3 = 18, D3 = 19, E3 = 20, F3 = 21, G3 = 22, H3 = 23, A4 = 24, B4 = 25, C4 = 26, D4 = 27, E4 = 28, F4 = 29, G4 = 30, H4 = 31, A5 = 32, B5 = 33, C5 = 34, D5 = 35, E5 = 36, F5 = 37, G5 = 38, H5 = 39, A6 = 40, B6 = 41, C6 = 42, D6 = 43, E6 = 44, F6 = 45, G6 = 46, H6 = 47, A7 = 48, B7 = 49, C7 = 50, D7 = 51, E7 = 52, F7 = 53, G7 = 54, H7 = 55, A8 = 56, B8 = 57, C8 = 58, D8 = 59, E8 = 60, F8 = 61, G8 = 62, H8 = 63;
 
     const std::string SQUARE_NAMES[] = {"a1", "b1", "c1", "d1", "e1", "f1", "g1", "h1", "a2", "b2", "c2", "d2", "e2", "f2", "g2", "h2", "a3", "b3", "c3", "d3", "e3", "f3", "g3", "h3", "a4", "b4", "c4", "d4", "e4", "f4", "g4", "h4", "a5", "b5", "c5", "d5", "e5", "f5", "g5", "h5", "a6", "b6", "c6", "d6", "e6", "f6", "g6", "h6", "a7", "b7", "c7", "d7", "e7", "f7", "g7", "h7", "a8", "b8", "c8", "d8", "e8", "f8", "g8", "h8"};
 
@@ -176,23 +187,56 @@ namespace chess
 
     std::string square_name(Square);
 
-    Square square(int, int);
+    constexpr Square square(int file_index, int rank_index)
+    {
+        /* Gets a square number by file and rank index. */
+        return rank_index * 8 + file_index;
+    }
 
-    int square_file(Square);
+    constexpr int square_file(Square square)
+    {
+        /* Gets the file index of the square where ``0`` is the a-file. */
+        return square & 7;
+    }
 
-    int square_rank(Square);
+    constexpr int square_rank(Square square)
+    {
+        /* Gets the rank index of the square where ``0`` is the first rank. */
+        return square >> 3;
+    }
 
-    int square_distance(Square, Square);
+    constexpr int square_distance(Square a, Square b)
+    {
+        /*
+        Gets the distance (i.e., the number of king steps) from square *a* to *b*.
+        */
+        int file_distance = square_file(a) - square_file(b);
+        int rank_distance = square_rank(a) - square_rank(b);
+        return std::max(file_distance < 0 ? -file_distance : file_distance,
+                        rank_distance < 0 ? -rank_distance : rank_distance);
+    }
 
-    Square square_mirror(Square);
+    constexpr Square square_mirror(Square square)
+    {
+        /* Mirrors the square vertically. */
+        return square ^ 0x38;
+    }
 
-    const Square SQUARES_180[] = {square_mirror(0), square_mirror(1), square_mirror(2), square_mirror(3), square_mirror(4), square_mirror(5), square_mirror(6), square_mirror(7), square_mirror(8), square_mirror(9), square_mirror(10), square_mirror(11), square_mirror(12), square_mirror(13), square_mirror(14), square_mirror(15), square_mirror(16), square_mirror(17), square_mirror(18), square_mirror(19), square_mirror(20), square_mirror(21), square_mirror(22), square_mirror(23), square_mirror(24), square_mirror(25), square_mirror(26), square_mirror(27), square_mirror(28), square_mirror(29), square_mirror(30), square_mirror(31), square_mirror(32), square_mirror(33), square_mirror(34), square_mirror(35), square_mirror(36), square_mirror(37), square_mirror(38), square_mirror(39), square_mirror(40), square_mirror(41), square_mirror(42), square_mirror(43), square_mirror(44), square_mirror(45), square_mirror(46), square_mirror(47), square_mirror(48), square_mirror(49), square_mirror(50), square_mirror(51), square_mirror(52), square_mirror(53), square_mirror(54), square_mirror(55), square_mirror(56), square_mirror(57), square_mirror(58), square_mirror(59), square_mirror(60), square_mirror(61), square_mirror(62), square_mirror(63)};
+    constexpr std::array<Square, 64> SQUARES_180 = []() constexpr
+    {
+        std::array<Square, 64> squares{};
+        for (Square square : SQUARES)
+        {
+            squares[square] = square_mirror(square);
+        }
+        return squares;
+    }();
 
     typedef unsigned long Bitboard;
     const Bitboard BB_EMPTY = 0;
     const Bitboard BB_ALL = 0xffff'ffff'ffff'ffff;
 
-    const Bitboard BB_SQUARES[] = {
+    constexpr Bitboard BB_SQUARES[] = {
         1UL << 0,
         1UL << 1,
         1UL << 2,
@@ -266,7 +310,7 @@ namespace chess
     const Bitboard BB_LIGHT_SQUARES = 0x55aa'55aa'55aa'55aa;
     const Bitboard BB_DARK_SQUARES = 0xaa55'aa55'aa55'aa55;
 
-    const Bitboard BB_FILES[] = {
+    constexpr Bitboard BB_FILES[] = {
         0x0101'0101'0101'0101UL << 0,
         0x0101'0101'0101'0101UL << 1,
         0x0101'0101'0101'0101UL << 2,
@@ -278,7 +322,7 @@ namespace chess
     },
                    BB_FILE_A = 0x0101'0101'0101'0101UL << 0, BB_FILE_B = 0x0101'0101'0101'0101UL << 1, BB_FILE_C = 0x0101'0101'0101'0101UL << 2, BB_FILE_D = 0x0101'0101'0101'0101UL << 3, BB_FILE_E = 0x0101'0101'0101'0101UL << 4, BB_FILE_F = 0x0101'0101'0101'0101UL << 5, BB_FILE_G = 0x0101'0101'0101'0101UL << 6, BB_FILE_H = 0x0101'0101'0101'0101UL << 7;
 
-    const Bitboard BB_RANKS[] = {
+    constexpr Bitboard BB_RANKS[] = {
         0xffUL << (8 * 0),
         0xffUL << (8 * 1),
         0xffUL << (8 * 2),
@@ -294,11 +338,101 @@ namespace chess
 
     int lsb(Bitboard);
 
-    std::vector<Square> scan_forward(Bitboard);
+    class _ScanForward
+    {
+        /*
+        A lazy, allocation-free range over the squares of a bitboard in
+        ascending order. Supports conversion to ``std::vector<Square>`` for
+        callers that need materialized squares.
+        */
+
+    public:
+        class iterator
+        {
+
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef Square value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const Square *pointer;
+            typedef Square reference;
+
+            iterator(Bitboard);
+
+            Square operator*() const;
+
+            iterator &operator++();
+
+            bool operator==(const iterator &) const;
+
+            bool operator!=(const iterator &) const;
+
+        private:
+            Bitboard _bb;
+        };
+
+        _ScanForward(Bitboard);
+
+        iterator begin() const;
+
+        iterator end() const;
+
+        operator std::vector<Square>() const;
+
+    private:
+        Bitboard _bb;
+    };
+
+    _ScanForward scan_forward(Bitboard);
 
     int msb(Bitboard);
 
-    std::vector<Square> scan_reversed(Bitboard);
+    class _ScanReversed
+    {
+        /*
+        A lazy, allocation-free range over the squares of a bitboard in
+        descending order. Supports conversion to ``std::vector<Square>`` for
+        callers that need materialized squares.
+        */
+
+    public:
+        class iterator
+        {
+
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef Square value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const Square *pointer;
+            typedef Square reference;
+
+            iterator(Bitboard);
+
+            Square operator*() const;
+
+            iterator &operator++();
+
+            bool operator==(const iterator &) const;
+
+            bool operator!=(const iterator &) const;
+
+        private:
+            Bitboard _bb;
+        };
+
+        _ScanReversed(Bitboard);
+
+        iterator begin() const;
+
+        iterator end() const;
+
+        operator std::vector<Square>() const;
+
+    private:
+        Bitboard _bb;
+    };
+
+    _ScanReversed scan_reversed(Bitboard);
 
     std::function<int(Bitboard)> popcount = [](Bitboard bb) -> int
     { return std::bitset<64>(bb).count(); };
@@ -335,36 +469,527 @@ namespace chess
 
     Bitboard shift_down_right(Bitboard);
 
-    Bitboard _sliding_attacks(Square, Bitboard, const std::vector<int> &);
+    Bitboard _fill_attacks(Bitboard, Bitboard, Bitboard (*)(Bitboard));
 
-    Bitboard _step_attacks(Square, const std::vector<int> &);
+    constexpr Bitboard _sliding_attacks(Square square, Bitboard occupied, const std::vector<int> &deltas)
+    {
+        Bitboard attacks = BB_EMPTY;
+
+        for (int delta : deltas)
+        {
+            Square sq = square;
+
+            while (true)
+            {
+                sq += delta;
+                if (!(0 <= sq && sq < 64) || square_distance(sq, sq - delta) > 2)
+                {
+                    break;
+                }
+
+                attacks |= BB_SQUARES[sq];
+
+                if (occupied & BB_SQUARES[sq])
+                {
+                    break;
+                }
+            }
+        }
+
+        return attacks;
+    }
 
-    const Bitboard BB_KNIGHT_ATTACKS[] = {_step_attacks(0, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(1, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(2, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(3, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(4, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(5, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(6, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(7, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(8, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(9, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(10, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(11, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(12, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(13, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(14, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(15, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(16, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(17, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(18, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(19, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(20, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(21, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(22, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(23, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(24, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(25, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(26, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(27, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(28, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(29, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(30, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(31, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(32, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(33, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(34, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(35, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(36, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(37, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(38, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(39, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(40, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(41, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(42, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(43, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(44, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(45, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(46, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(47, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(48, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(49, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(50, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(51, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(52, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(53, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(54, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(55, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(56, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(57, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(58, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(59, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(60, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(61, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(62, {17, 15, 10, 6, -17, -15, -10, -6}), _step_attacks(63, {17, 15, 10, 6, -17, -15, -10, -6})};
-    const Bitboard BB_KING_ATTACKS[] = {_step_attacks(0, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(1, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(2, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(3, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(4, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(5, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(6, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(7, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(8, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(9, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(10, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(11, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(12, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(13, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(14, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(15, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(16, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(17, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(18, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(19, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(20, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(21, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(22, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(23, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(24, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(25, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(26, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(27, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(28, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(29, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(30, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(31, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(32, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(33, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(34, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(35, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(36, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(37, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(38, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(39, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(40, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(41, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(42, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(43, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(44, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(45, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(46, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(47, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(48, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(49, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(50, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(51, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(52, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(53, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(54, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(55, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(56, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(57, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(58, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(59, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(60, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(61, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(62, {9, 8, 7, 1, -9, -8, -7, -1}), _step_attacks(63, {9, 8, 7, 1, -9, -8, -7, -1})};
-    const Bitboard BB_PAWN_ATTACKS[][64] = {{_step_attacks(0, {-7, -9}), _step_attacks(1, {-7, -9}), _step_attacks(2, {-7, -9}), _step_attacks(3, {-7, -9}), _step_attacks(4, {-7, -9}), _step_attacks(5, {-7, -9}), _step_attacks(6, {-7, -9}), _step_attacks(7, {-7, -9}), _step_attacks(8, {-7, -9}), _step_attacks(9, {-7, -9}), _step_attacks(10, {-7, -9}), _step_attacks(11, {-7, -9}), _step_attacks(12, {-7, -9}), _step_attacks(13, {-7, -9}), _step_attacks(14, {-7, -9}), _step_attacks(15, {-7, -9}), _step_attacks(16, {-7, -9}), _step_attacks(17, {-7, -9}), _step_attacks(18, {-7, -9}), _step_attacks(19, {-7, -9}), _step_attacks(20, {-7, -9}), _step_attacks(21, {-7, -9}), _step_attacks(22, {-7, -9}), _step_attacks(23, {-7, -9}), _step_attacks(24, {-7, -9}), _step_attacks(25, {-7, -9}), _step_attacks(26, {-7, -9}), _step_attacks(27, {-7, -9}), _step_attacks(28, {-7, -9}), _step_attacks(29, {-7, -9}), _step_attacks(30, {-7, -9}), _step_attacks(31, {-7, -9}), _step_attacks(32, {-7, -9}), _step_attacks(33, {-7, -9}), _step_attacks(34, {-7, -9}), _step_attacks(35, {-7, -9}), _step_attacks(36, {-7, -9}), _step_attacks(37, {-7, -9}), _step_attacks(38, {-7, -9}), _step_attacks(39, {-7, -9}), _step_attacks(40, {-7, -9}), _step_attacks(41, {-7, -9}), _step_attacks(42, {-7, -9}), _step_attacks(43, {-7, -9}), _step_attacks(44, {-7, -9}), _step_attacks(45, {-7, -9}), _step_attacks(46, {-7, -9}), _step_attacks(47, {-7, -9}), _step_attacks(48, {-7, -9}), _step_attacks(49, {-7, -9}), _step_attacks(50, {-7, -9}), _step_attacks(51, {-7, -9}), _step_attacks(52, {-7, -9}), _step_attacks(53, {-7, -9}), _step_attacks(54, {-7, -9}), _step_attacks(55, {-7, -9}), _step_attacks(56, {-7, -9}), _step_attacks(57, {-7, -9}), _step_attacks(58, {-7, -9}), _step_attacks(59, {-7, -9}), _step_attacks(60, {-7, -9}), _step_attacks(61, {-7, -9}), _step_attacks(62, {-7, -9}), _step_attacks(63, {-7, -9})}, {_step_attacks(0, {7, 9}), _step_attacks(1, {7, 9}), _step_attacks(2, {7, 9}), _step_attacks(3, {7, 9}), _step_attacks(4, {7, 9}), _step_attacks(5, {7, 9}), _step_attacks(6, {7, 9}), _step_attacks(7, {7, 9}), _step_attacks(8, {7, 9}), _step_attacks(9, {7, 9}), _step_attacks(10, {7, 9}), _step_attacks(11, {7, 9}), _step_attacks(12, {7, 9}), _step_attacks(13, {7, 9}), _step_attacks(14, {7, 9}), _step_attacks(15, {7, 9}), _step_attacks(16, {7, 9}), _step_attacks(17, {7, 9}), _step_attacks(18, {7, 9}), _step_attacks(19, {7, 9}), _step_attacks(20, {7, 9}), _step_attacks(21, {7, 9}), _step_attacks(22, {7, 9}), _step_attacks(23, {7, 9}), _step_attacks(24, {7, 9}), _step_attacks(25, {7, 9}), _step_attacks(26, {7, 9}), _step_attacks(27, {7, 9}), _step_attacks(28, {7, 9}), _step_attacks(29, {7, 9}), _step_attacks(30, {7, 9}), _step_attacks(31, {7, 9}), _step_attacks(32, {7, 9}), _step_attacks(33, {7, 9}), _step_attacks(34, {7, 9}), _step_attacks(35, {7, 9}), _step_attacks(36, {7, 9}), _step_attacks(37, {7, 9}), _step_attacks(38, {7, 9}), _step_attacks(39, {7, 9}), _step_attacks(40, {7, 9}), _step_attacks(41, {7, 9}), _step_attacks(42, {7, 9}), _step_attacks(43, {7, 9}), _step_attacks(44, {7, 9}), _step_attacks(45, {7, 9}), _step_attacks(46, {7, 9}), _step_attacks(47, {7, 9}), _step_attacks(48, {7, 9}), _step_attacks(49, {7, 9}), _step_attacks(50, {7, 9}), _step_attacks(51, {7, 9}), _step_attacks(52, {7, 9}), _step_attacks(53, {7, 9}), _step_attacks(54, {7, 9}), _step_attacks(55, {7, 9}), _step_attacks(56, {7, 9}), _step_attacks(57, {7, 9}), _step_attacks(58, {7, 9}), _step_attacks(59, {7, 9}), _step_attacks(60, {7, 9}), _step_attacks(61, {7, 9}), _step_attacks(62, {7, 9}), _step_attacks(63, {7, 9})}};
+    constexpr Bitboard _step_attacks(Square square, const std::vector<int> &deltas)
+    {
+        return _sliding_attacks(square, BB_ALL, deltas);
+    }
 
-    Bitboard _edges(Square);
+    constexpr std::array<Bitboard, 64> BB_KNIGHT_ATTACKS = []() constexpr
+    {
+        std::array<Bitboard, 64> attacks{};
+        for (Square square : SQUARES)
+        {
+            attacks[square] = _step_attacks(square, {17, 15, 10, 6, -17, -15, -10, -6});
+        }
+        return attacks;
+    }();
+    constexpr std::array<Bitboard, 64> BB_KING_ATTACKS = []() constexpr
+    {
+        std::array<Bitboard, 64> attacks{};
+        for (Square square : SQUARES)
+        {
+            attacks[square] = _step_attacks(square, {9, 8, 7, 1, -9, -8, -7, -1});
+        }
+        return attacks;
+    }();
+    constexpr std::array<std::array<Bitboard, 64>, 2> BB_PAWN_ATTACKS = []() constexpr
+    {
+        std::array<std::array<Bitboard, 64>, 2> attacks{};
+        for (Square square : SQUARES)
+        {
+            attacks[BLACK][square] = _step_attacks(square, {-7, -9});
+            attacks[WHITE][square] = _step_attacks(square, {7, 9});
+        }
+        return attacks;
+    }();
+
+    constexpr Bitboard _edges(Square square)
+    {
+        return (((BB_RANK_1 | BB_RANK_8) & ~BB_RANKS[square_rank(square)]) |
+                ((BB_FILE_A | BB_FILE_H) & ~BB_FILES[square_file(square)]));
+    }
 
     std::vector<Bitboard> _carry_rippler(Bitboard);
 
-    std::tuple<std::vector<Bitboard>, std::vector<std::unordered_map<Bitboard, Bitboard>>> _attack_table(const std::vector<int> &);
+    class _MagicAttacks
+    {
+        /*
+        Sliding attacks for a single square, looked up from a flat
+        preallocated table with fixed-shift magic indexing instead of a hash
+        of the occupancy mask.
+        */
+
+    public:
+        Bitboard mask;
+        Bitboard magic;
+        int shift;
+        std::vector<Bitboard> table;
+
+        Bitboard at(Bitboard) const;
+    };
+
+    _MagicAttacks _find_magic(Bitboard, const std::vector<Bitboard> &, const std::vector<Bitboard> &);
+
+    std::tuple<std::vector<Bitboard>, std::vector<_MagicAttacks>> _attack_table(const std::vector<int> &);
 
     const auto [BB_DIAG_MASKS, BB_DIAG_ATTACKS] = _attack_table({-9, -7, 7, 9});
     const auto [BB_FILE_MASKS, BB_FILE_ATTACKS] = _attack_table({-8, 8});
     const auto [BB_RANK_MASKS, BB_RANK_ATTACKS] = _attack_table({-1, 1});
 
-    std::vector<std::vector<Bitboard>> _rays();
+    constexpr std::array<std::array<Bitboard, 64>, 64> _rays()
+    {
+        std::array<std::array<Bitboard, 64>, 64> rays{};
+        for (int a = 0; a < 64; ++a)
+        {
+            Bitboard bb_a = BB_SQUARES[a];
+            Bitboard diag = _sliding_attacks(a, 0, {-9, -7, 7, 9});
+            Bitboard rank = _sliding_attacks(a, 0, {-1, 1});
+            Bitboard file = _sliding_attacks(a, 0, {-8, 8});
+            for (int b = 0; b < 64; ++b)
+            {
+                Bitboard bb_b = BB_SQUARES[b];
+                if (diag & bb_b)
+                {
+                    rays[a][b] = (diag & _sliding_attacks(b, 0, {-9, -7, 7, 9})) | bb_a | bb_b;
+                }
+                else if (rank & bb_b)
+                {
+                    rays[a][b] = rank | bb_a;
+                }
+                else if (file & bb_b)
+                {
+                    rays[a][b] = file | bb_a;
+                }
+                else
+                {
+                    rays[a][b] = BB_EMPTY;
+                }
+            }
+        }
+        return rays;
+    }
 
-    const std::vector<std::vector<Bitboard>> BB_RAYS = _rays();
+    constexpr std::array<std::array<Bitboard, 64>, 64> BB_RAYS = _rays();
 
     Bitboard ray(Square, Square);
 
     Bitboard between(Square, Square);
 
+    constexpr std::array<Bitboard, 781> ZOBRIST_RANDOM_ARRAY = {
+        0x9D39247E33776D41, 0x2AF7398005AAA5C7, 0x44DB015024623547, 0x9C15F73E62A76AE2,
+        0x75834465489C0C89, 0x3290AC3A203001BF, 0x0FBBAD1F61042279, 0xE83A908FF2FB60CA,
+        0x0D7E765D58755C10, 0x1A083822CEAFE02D, 0x9605D5F0E25EC3B0, 0xD021FF5CD13A2ED5,
+        0x40BDF15D4A672E32, 0x011355146FD56395, 0x5DB4832046F3D9E5, 0x239F8B2D7FF719CC,
+        0x05D1A1AE85B49AA1, 0x679F848F6E8FC971, 0x7449BBFF801FED0B, 0x7D11CDB1C3B7ADF0,
+        0x82C7709E781EB7CC, 0xF3218F1C9510786C, 0x331478F3AF51BBE6, 0x4BB38DE5E7219443,
+        0xAA649C6EBCFD50FC, 0x8DBD98A352AFD40B, 0x87D2074B81D79217, 0x19F3C751D3E92AE1,
+        0xB4AB30F062B19ABF, 0x7B0500AC42047AC4, 0xC9452CA81A09D85D, 0x24AA6C514DA27500,
+        0x4C9F34427501B447, 0x14A68FD73C910841, 0xA71B9B83461CBD93, 0x03488B95B0F1850F,
+        0x637B2B34FF93C040, 0x09D1BC9A3DD90A94, 0x3575668334A1DD3B, 0x735E2B97A4C45A23,
+        0x18727070F1BD400B, 0x1FCBACD259BF02E7, 0xD310A7C2CE9B6555, 0xBF983FE0FE5D8244,
+        0x9F74D14F7454A824, 0x51EBDC4AB9BA3035, 0x5C82C505DB9AB0FA, 0xFCF7FE8A3430B241,
+        0x3253A729B9BA3DDE, 0x8C74C368081B3075, 0xB9BC6C87167C33E7, 0x7EF48F2B83024E20,
+        0x11D505D4C351BD7F, 0x6568FCA92C76A243, 0x4DE0B0F40F32A7B8, 0x96D693460CC37E5D,
+        0x42E240CB63689F2F, 0x6D2BDCDAE2919661, 0x42880B0236E4D951, 0x5F0F4A5898171BB6,
+        0x39F890F579F92F88, 0x93C5B5F47356388B, 0x63DC359D8D231B78, 0xEC16CA8AEA98AD76,
+        0x5355F900C2A82DC7, 0x07FB9F855A997142, 0x5093417AA8A7ED5E, 0x7BCBC38DA25A7F3C,
+        0x19FC8A768CF4B6D4, 0x637A7780DECFC0D9, 0x8249A47AEE0E41F7, 0x79AD695501E7D1E8,
+        0x14ACBAF4777D5776, 0xF145B6BECCDEA195, 0xDABF2AC8201752FC, 0x24C3C94DF9C8D3F6,
+        0xBB6E2924F03912EA, 0x0CE26C0B95C980D9, 0xA49CD132BFBF7CC4, 0xE99D662AF4243939,
+        0x27E6AD7891165C3F, 0x8535F040B9744FF1, 0x54B3F4FA5F40D873, 0x72B12C32127FED2B,
+        0xEE954D3C7B411F47, 0x9A85AC909A24EAA1, 0x70AC4CD9F04F21F5, 0xF9B89D3E99A075C2,
+        0x87B3E2B2B5C907B1, 0xA366E5B8C54F48B8, 0xAE4A9346CC3F7CF2, 0x1920C04D47267BBD,
+        0x87BF02C6B49E2AE9, 0x092237AC237F3859, 0xFF07F64EF8ED14D0, 0x8DE8DCA9F03CC54E,
+        0x9C1633264DB49C89, 0xB3F22C3D0B0B38ED, 0x390E5FB44D01144B, 0x5BFEA5B4712768E9,
+        0x1E1032911FA78984, 0x9A74ACB964E78CB3, 0x4F80F7A035DAFB04, 0x6304D09A0B3738C4,
+        0x2171E64683023A08, 0x5B9B63EB9CEFF80C, 0x506AACF489889342, 0x1881AFC9A3A701D6,
+        0x6503080440750644, 0xDFD395339CDBF4A7, 0xEF927DBCF00C20F2, 0x7B32F7D1E03680EC,
+        0xB9FD7620E7316243, 0x05A7E8A57DB91B77, 0xB5889C6E15630A75, 0x4A750A09CE9573F7,
+        0xCF464CEC899A2F8A, 0xF538639CE705B824, 0x3C79A0FF5580EF7F, 0xEDE6C87F8477609D,
+        0x799E81F05BC93F31, 0x86536B8CF3428A8C, 0x97D7374C60087B73, 0xA246637CFF328532,
+        0x043FCAE60CC0EABB, 0x920E449535DD359E, 0x70EB093B15B290CC, 0x73A1921916591CBD,
+        0x56436C9FE1A1AA8D, 0xEFAC4B70633B8F81, 0xBB215798D45DF7AF, 0x45F20042F24F1768,
+        0x930F80F4E8EB7462, 0xFF6712FFCFD75EA1, 0xAE623FD67468AA70, 0xDD2C5BC84BC8D8FC,
+        0x7EED120D54CF2DD9, 0x22FE545401165F1C, 0xC91800E98FB99929, 0x808BD68E6AC10365,
+        0xDEC468145B7605F6, 0x1BEDE3A3AEF53302, 0x43539603D6C55602, 0xAA969B5C691CCB7A,
+        0xA87832D392EFEE56, 0x65942C7B3C7E11AE, 0xDED2D633CAD004F6, 0x21F08570F420E565,
+        0xB415938D7DA94E3C, 0x91B859E59ECB6350, 0x10CFF333E0ED804A, 0x28AED140BE0BB7DD,
+        0xC5CC1D89724FA456, 0x5648F680F11A2741, 0x2D255069F0B7DAB3, 0x9BC5A38EF729ABD4,
+        0xEF2F054308F6A2BC, 0xAF2042F5CC5C2858, 0x480412BAB7F5BE2A, 0xAEF3AF4A563DFE43,
+        0x19AFE59AE451497F, 0x52593803DFF1E840, 0xF4F076E65F2CE6F0, 0x11379625747D5AF3,
+        0xBCE5D2248682C115, 0x9DA4243DE836994F, 0x066F70B33FE09017, 0x4DC4DE189B671A1C,
+        0x51039AB7712457C3, 0xC07A3F80C31FB4B4, 0xB46EE9C5E64A6E7C, 0xB3819A42ABE61C87,
+        0x21A007933A522A20, 0x2DF16F761598AA4F, 0x763C4A1371B368FD, 0xF793C46702E086A0,
+        0xD7288E012AEB8D31, 0xDE336A2A4BC1C44B, 0x0BF692B38D079F23, 0x2C604A7A177326B3,
+        0x4850E73E03EB6064, 0xCFC447F1E53C8E1B, 0xB05CA3F564268D99, 0x9AE182C8BC9474E8,
+        0xA4FC4BD4FC5558CA, 0xE755178D58FC4E76, 0x69B97DB1A4C03DFE, 0xF9B5B7C4ACC67C96,
+        0xFC6A82D64B8655FB, 0x9C684CB6C4D24417, 0x8EC97D2917456ED0, 0x6703DF9D2924E97E,
+        0xC547F57E42A7444E, 0x78E37644E7CAD29E, 0xFE9A44E9362F05FA, 0x08BD35CC38336615,
+        0x9315E5EB3A129ACE, 0x94061B871E04DF75, 0xDF1D9F9D784BA010, 0x3BBA57B68871B59D,
+        0xD2B7ADEEDED1F73F, 0xF7A255D83BC373F8, 0xD7F4F2448C0CEB81, 0xD95BE88CD210FFA7,
+        0x336F52F8FF4728E7, 0xA74049DAC312AC71, 0xA2F61BB6E437FDB5, 0x4F2A5CB07F6A35B3,
+        0x87D380BDA5BF7859, 0x16B9F7E06C453A21, 0x7BA2484C8A0FD54E, 0xF3A678CAD9A2E38C,
+        0x39B0BF7DDE437BA2, 0xFCAF55C1BF8A4424, 0x18FCF680573FA594, 0x4C0563B89F495AC3,
+        0x40E087931A00930D, 0x8CFFA9412EB642C1, 0x68CA39053261169F, 0x7A1EE967D27579E2,
+        0x9D1D60E5076F5B6F, 0x3810E399B6F65BA2, 0x32095B6D4AB5F9B1, 0x35CAB62109DD038A,
+        0xA90B24499FCFAFB1, 0x77A225A07CC2C6BD, 0x513E5E634C70E331, 0x4361C0CA3F692F12,
+        0xD941ACA44B20A45B, 0x528F7C8602C5807B, 0x52AB92BEB9613989, 0x9D1DFA2EFC557F73,
+        0x722FF175F572C348, 0x1D1260A51107FE97, 0x7A249A57EC0C9BA2, 0x04208FE9E8F7F2D6,
+        0x5A110C6058B920A0, 0x0CD9A497658A5698, 0x56FD23C8F9715A4C, 0x284C847B9D887AAE,
+        0x04FEABFBBDB619CB, 0x742E1E651C60BA83, 0x9A9632E65904AD3C, 0x881B82A13B51B9E2,
+        0x506E6744CD974924, 0xB0183DB56FFC6A79, 0x0ED9B915C66ED37E, 0x5E11E86D5873D484,
+        0xF678647E3519AC6E, 0x1B85D488D0F20CC5, 0xDAB9FE6525D89021, 0x0D151D86ADB73615,
+        0xA865A54EDCC0F019, 0x93C42566AEF98FFB, 0x99E7AFEABE000731, 0x48CBFF086DDF285A,
+        0x7F9B6AF1EBF78BAF, 0x58627E1A149BBA21, 0x2CD16E2ABD791E33, 0xD363EFF5F0977996,
+        0x0CE2A38C344A6EED, 0x1A804AADB9CFA741, 0x907F30421D78C5DE, 0x501F65EDB3034D07,
+        0x37624AE5A48FA6E9, 0x957BAF61700CFF4E, 0x3A6C27934E31188A, 0xD49503536ABCA345,
+        0x088E049589C432E0, 0xF943AEE7FEBF21B8, 0x6C3B8E3E336139D3, 0x364F6FFA464EE52E,
+        0xD60F6DCEDC314222, 0x56963B0DCA418FC0, 0x16F50EDF91E513AF, 0xEF1955914B609F93,
+        0x565601C0364E3228, 0xECB53939887E8175, 0xBAC7A9A18531294B, 0xB344C470397BBA52,
+        0x65D34954DAF3CEBD, 0xB4B81B3FA97511E2, 0xB422061193D6F6A7, 0x071582401C38434D,
+        0x7A13F18BBEDC4FF5, 0xBC4097B116C524D2, 0x59B97885E2F2EA28, 0x99170A5DC3115544,
+        0x6F423357E7C6A9F9, 0x325928EE6E6F8794, 0xD0E4366228B03343, 0x565C31F7DE89EA27,
+        0x30F5611484119414, 0xD873DB391292ED4F, 0x7BD94E1D8E17DEBC, 0xC7D9F16864A76E94,
+        0x947AE053EE56E63C, 0xC8C93882F9475F5F, 0x3A9BF55BA91F81CA, 0xD9A11FBB3D9808E4,
+        0x0FD22063EDC29FCA, 0xB3F256D8ACA0B0B9, 0xB03031A8B4516E84, 0x35DD37D5871448AF,
+        0xE9F6082B05542E4E, 0xEBFAFA33D7254B59, 0x9255ABB50D532280, 0xB9AB4CE57F2D34F3,
+        0x693501D628297551, 0xC62C58F97DD949BF, 0xCD454F8F19C5126A, 0xBBE83F4ECC2BDECB,
+        0xDC842B7E2819E230, 0xBA89142E007503B8, 0xA3BC941D0A5061CB, 0xE9F6760E32CD8021,
+        0x09C7E552BC76492F, 0x852F54934DA55CC9, 0x8107FCCF064FCF56, 0x098954D51FFF6580,
+        0x23B70EDB1955C4BF, 0xC330DE426430F69D, 0x4715ED43E8A45C0A, 0xA8D7E4DAB780A08D,
+        0x0572B974F03CE0BB, 0xB57D2E985E1419C7, 0xE8D9ECBE2CF3D73F, 0x2FE4B17170E59750,
+        0x11317BA87905E790, 0x7FBF21EC8A1F45EC, 0x1725CABFCB045B00, 0x964E915CD5E2B207,
+        0x3E2B8BCBF016D66D, 0xBE7444E39328A0AC, 0xF85B2B4FBCDE44B7, 0x49353FEA39BA63B1,
+        0x1DD01AAFCD53486A, 0x1FCA8A92FD719F85, 0xFC7C95D827357AFA, 0x18A6A990C8B35EBD,
+        0xCCCB7005C6B9C28D, 0x3BDBB92C43B17F26, 0xAA70B5B4F89695A2, 0xE94C39A54A98307F,
+        0xB7A0B174CFF6F36E, 0xD4DBA84729AF48AD, 0x2E18BC1AD9704A68, 0x2DE0966DAF2F8B1C,
+        0xB9C11D5B1E43A07E, 0x64972D68DEE33360, 0x94628D38D0C20584, 0xDBC0D2B6AB90A559,
+        0xD2733C4335C6A72F, 0x7E75D99D94A70F4D, 0x6CED1983376FA72B, 0x97FCAACBF030BC24,
+        0x7B77497B32503B12, 0x8547EDDFB81CCB94, 0x79999CDFF70902CB, 0xCFFE1939438E9B24,
+        0x829626E3892D95D7, 0x92FAE24291F2B3F1, 0x63E22C147B9C3403, 0xC678B6D860284A1C,
+        0x5873888850659AE7, 0x0981DCD296A8736D, 0x9F65789A6509A440, 0x9FF38FED72E9052F,
+        0xE479EE5B9930578C, 0xE7F28ECD2D49EECD, 0x56C074A581EA17FE, 0x5544F7D774B14AEF,
+        0x7B3F0195FC6F290F, 0x12153635B2C0CF57, 0x7F5126DBBA5E0CA7, 0x7A76956C3EAFB413,
+        0x3D5774A11D31AB39, 0x8A1B083821F40CB4, 0x7B4A38E32537DF62, 0x950113646D1D6E03,
+        0x4DA8979A0041E8A9, 0x3BC36E078F7515D7, 0x5D0A12F27AD310D1, 0x7F9D1A2E1EBE1327,
+        0xDA3A361B1C5157B1, 0xDCDD7D20903D0C25, 0x36833336D068F707, 0xCE68341F79893389,
+        0xAB9090168DD05F34, 0x43954B3252DC25E5, 0xB438C2B67F98E5E9, 0x10DCD78E3851A492,
+        0xDBC27AB5447822BF, 0x9B3CDB65F82CA382, 0xB67B7896167B4C84, 0xBFCED1B0048EAC50,
+        0xA9119B60369FFEBD, 0x1FFF7AC80904BF45, 0xAC12FB171817EEE7, 0xAF08DA9177DDA93D,
+        0x1B0CAB936E65C744, 0xB559EB1D04E5E932, 0xC37B45B3F8D6F2BA, 0xC3A9DC228CAAC9E9,
+        0xF3B8B6675A6507FF, 0x9FC477DE4ED681DA, 0x67378D8ECCEF96CB, 0x6DD856D94D259236,
+        0xA319CE15B0B4DB31, 0x073973751F12DD5E, 0x8A8E849EB32781A5, 0xE1925C71285279F5,
+        0x74C04BF1790C0EFE, 0x4DDA48153C94938A, 0x9D266D6A1CC0542C, 0x7440FB816508C4FE,
+        0x13328503DF48229F, 0xD6BF7BAEE43CAC40, 0x4838D65F6EF6748F, 0x1E152328F3318DEA,
+        0x8F8419A348F296BF, 0x72C8834A5957B511, 0xD7A023A73260B45C, 0x94EBC8ABCFB56DAE,
+        0x9FC10D0F989993E0, 0xDE68A2355B93CAE6, 0xA44CFE79AE538BBE, 0x9D1D84FCCE371425,
+        0x51D2B1AB2DDFB636, 0x2FD7E4B9E72CD38C, 0x65CA5B96B7552210, 0xDD69A0D8AB3B546D,
+        0x604D51B25FBF70E2, 0x73AA8A564FB7AC9E, 0x1A8C1E992B941148, 0xAAC40A2703D9BEA0,
+        0x764DBEAE7FA4F3A6, 0x1E99B96E70A9BE8B, 0x2C5E9DEB57EF4743, 0x3A938FEE32D29981,
+        0x26E6DB8FFDF5ADFE, 0x469356C504EC9F9D, 0xC8763C5B08D1908C, 0x3F6C6AF859D80055,
+        0x7F7CC39420A3A545, 0x9BFB227EBDF4C5CE, 0x89039D79D5C5C3C0, 0x8FE88B57305E2AB6,
+        0xA09E8C8C35AB96DE, 0xFA7E393983325753, 0xD6B6D0ECC617C699, 0xDFEA21EA9E7557E3,
+        0xB67C1FA481680AF8, 0xCA1E3785A9E724E5, 0x1CFC8BED0D681639, 0xD18D8549D140CAEA,
+        0x4ED0FE7E9DC91335, 0xE4DBF0634473F5D2, 0x1761F93A44D5AEFE, 0x53898E4C3910DA55,
+        0x734DE8181F6EC39A, 0x2680B122BAA28D97, 0x298AF231C85BAFAB, 0x7983EED3740847D5,
+        0x66C1A2A1A60CD889, 0x9E17E49642A3E4C1, 0xEDB454E7BADC0805, 0x50B704CAB602C329,
+        0x4CC317FB9CDDD023, 0x66B4835D9EAFEA22, 0x219B97E26FFC81BD, 0x261E4E4C0A333A9D,
+        0x1FE7015D502552D9, 0xD7504DFA8816EDBB, 0xB9571FA04DC089C8, 0x1DDC0325259B27DE,
+        0xCF3F4688801EB9AA, 0xF4F5D05C10CAB243, 0x38B6525C21A42B0E, 0x36F60E2BA4FA6800,
+        0xEB3593803173E0CE, 0x9C4CD6257C5A3603, 0xAF0C317D32ADAA8A, 0x258E5A80C7204C4B,
+        0x8B889D624D44885D, 0xF4D14597E660F855, 0xD4347F66EC8941C3, 0xE699ED85B0DFB40D,
+        0x2472F6207C2D0484, 0xC2A1E7B5B459AEB5, 0xAB4F6451CC1D45EC, 0x63767572AE3D6174,
+        0xA59E0BD101731A28, 0x116D0016CB948F09, 0x2CF9C8CA052F6E9F, 0x0B090A7560A968E3,
+        0xABEEDDB2DDE06FF1, 0x58EFC10B06A2068D, 0xC6E57A78FBD986E0, 0x2EAB8CA63CE802D7,
+        0x14A195640116F336, 0x7C0828DD624EC390, 0xD74BBE77E6116AC7, 0x804456AF10F5FB53,
+        0xEBE9EA2ADF4321C7, 0x03219A39EE587A30, 0x49787FEF17AF9924, 0xA1E9300CD8520548,
+        0x5B45E522E4B1B4EF, 0xB49C3B3995091A36, 0xD4490AD526F14431, 0x12A8F216AF9418C2,
+        0x001F837CC7350524, 0x1877B51E57A764D5, 0xA2853B80F17F58EE, 0x993E1DE72D36D310,
+        0xB3598080CE64A656, 0x252F59CF0D9F04BB, 0xD23C8E176D113600, 0x1BDA0492E7E4586E,
+        0x21E0BD5026C619BF, 0x3B097ADAF088F94E, 0x8D14DEDB30BE846E, 0xF95CFFA23AF5F6F4,
+        0x3871700761B3F743, 0xCA672B91E9E4FA16, 0x64C8E531BFF53B55, 0x241260ED4AD1E87D,
+        0x106C09B972D2E822, 0x7FBA195410E5CA30, 0x7884D9BC6CB569D8, 0x0647DFEDCD894A29,
+        0x63573FF03E224774, 0x4FC8E9560F91B123, 0x1DB956E450275779, 0xB8D91274B9E9D4FB,
+        0xA2EBEE47E2FBFCE1, 0xD9F1F30CCD97FB09, 0xEFED53D75FD64E6B, 0x2E6D02C36017F67F,
+        0xA9AA4D20DB084E9B, 0xB64BE8D8B25396C1, 0x70CB6AF7C2D5BCF0, 0x98F076A4F7A2322E,
+        0xBF84470805E69B5F, 0x94C3251F06F90CF3, 0x3E003E616A6591E9, 0xB925A6CD0421AFF3,
+        0x61BDD1307C66E300, 0xBF8D5108E27E0D48, 0x240AB57A8B888B20, 0xFC87614BAF287E07,
+        0xEF02CDD06FFDB432, 0xA1082C0466DF6C0A, 0x8215E577001332C8, 0xD39BB9C3A48DB6CF,
+        0x2738259634305C14, 0x61CF4F94C97DF93D, 0x1B6BACA2AE4E125B, 0x758F450C88572E0B,
+        0x959F587D507A8359, 0xB063E962E045F54D, 0x60E8ED72C0DFF5D1, 0x7B64978555326F9F,
+        0xFD080D236DA814BA, 0x8C90FD9B083F4558, 0x106F72FE81E2C590, 0x7976033A39F7D952,
+        0xA4EC0132764CA04B, 0x733EA705FAE4FA77, 0xB4D8F77BC3E56167, 0x9E21F4F903B33FD9,
+        0x9D765E419FB69F6D, 0xD30C088BA61EA5EF, 0x5D94337FBFAF7F5B, 0x1A4E4822EB4D7A59,
+        0x6FFE73E81B637FB3, 0xDDF957BC36D8B9CA, 0x64D0E29EEA8838B3, 0x08DD9BDFD96B9F63,
+        0x087E79E5A57D1D13, 0xE328E230E3E2B3FB, 0x1C2559E30F0946BE, 0x720BF5F26F4D2EAA,
+        0xB0774D261CC609DB, 0x443F64EC5A371195, 0x4112CF68649A260E, 0xD813F2FAB7F5C5CA,
+        0x660D3257380841EE, 0x59AC2C7873F910A3, 0xE846963877671A17, 0x93B633ABFA3469F8,
+        0xC0C0F5A60EF4CDCF, 0xCAF21ECD4377B28C, 0x57277707199B8175, 0x506C11B9D90E8B1D,
+        0xD83CC2687A19255F, 0x4A29C6465A314CD1, 0xED2DF21216235097, 0xB5635C95FF7296E2,
+        0x22AF003AB672E811, 0x52E762596BF68235, 0x9AEBA33AC6ECC6B0, 0x944F6DE09134DFB6,
+        0x6C47BEC883A7DE39, 0x6AD047C430A12104, 0xA5B1CFDBA0AB4067, 0x7C45D833AFF07862,
+        0x5092EF950A16DA0B, 0x9338E69C052B8E7B, 0x455A4B4CFE30E3F5, 0x6B02E63195AD0CF8,
+        0x6B17B224BAD6BF27, 0xD1E0CCD25BB9C169, 0xDE0C89A556B9AE70, 0x50065E535A213CF6,
+        0x9C1169FA2777B874, 0x78EDEFD694AF1EED, 0x6DC93D9526A50E68, 0xEE97F453F06791ED,
+        0x32AB0EDB696703D3, 0x3A6853C7E70757A7, 0x31865CED6120F37D, 0x67FEF95D92607890,
+        0x1F2B1D1F15F6DC9C, 0xB69E38A8965C6B65, 0xAA9119FF184CCCF4, 0xF43C732873F24C13,
+        0xFB4A3D794A9A80D2, 0x3550C2321FD6109C, 0x371F77E76BB8417E, 0x6BFA9AAE5EC05779,
+        0xCD04F3FF001A4778, 0xE3273522064480CA, 0x9F91508BFFCFC14A, 0x049A7F41061A9E60,
+        0xFCB6BE43A9F2FE9B, 0x08DE8A1C7797DA9B, 0x8F9887E6078735A1, 0xB5B4071DBFC73A66,
+        0x230E343DFBA08D33, 0x43ED7F5A0FAE657D, 0x3A88A0FBBCB05C63, 0x21874B8B4D2DBC4F,
+        0x1BDEA12E35F6A8C9, 0x53C065C6C8E63528, 0xE34A1D250E7A8D6B, 0xD6B04D3B7651DD7E,
+        0x5E90277E7CB39E2D, 0x2C046F22062DC67D, 0xB10BB459132D0A26, 0x3FA9DDFB67E2F199,
+        0x0E09B88E1914F7AF, 0x10E8B35AF3EEAB37, 0x9EEDECA8E272B933, 0xD4C718BC4AE8AE5F,
+        0x81536D601170FC20, 0x91B534F885818A06, 0xEC8177F83F900978, 0x190E714FADA5156E,
+        0xB592BF39B0364963, 0x89C350C893AE7DC1, 0xAC042E70F8B383F2, 0xB49B52E587A1EE60,
+        0xFB152FE3FF26DA89, 0x3E666E6F69AE2C15, 0x3B544EBE544C19F9, 0xE805A1E290CF2456,
+        0x24B33C9D7ED25117, 0xE74733427B72F0C1, 0x0A804D18B7097475, 0x57E3306D881EDB4F,
+        0x4AE7D6A36EB5DBCB, 0x2D8D5432157064C8, 0xD1E649DE1E7F268B, 0x8A328A1CEDFE552C,
+        0x07A3AEC79624C7DA, 0x84547DDC3E203C94, 0x990A98FD5071D263, 0x1A4FF12616EEFC89,
+        0xF6F7FD1431714200, 0x30C05B1BA332F41C, 0x8D2636B81555A786, 0x46C9FEB55D120902,
+        0xCCEC0A73B49C9921, 0x4E9D2827355FC492, 0x19EBB029435DCB0F, 0x4659D2B743848A2C,
+        0x963EF2C96B33BE31, 0x74F85198B05A2E7D, 0x5A0F544DD2B1FB18, 0x03727073C2E134B1,
+        0xC7F6AA2DE59AEA61, 0x352787BAA0D7C22F, 0x9853EAB63B5E0B35, 0xABBDCDD7ED5C0860,
+        0xCF05DAF5AC8D77B0, 0x49CAD48CEBF4A71E, 0x7A4C10EC2158C4A6, 0xD9E92AA246BF719E,
+        0x13AE978D09FE5557, 0x730499AF921549FF, 0x4E4B705B92903BA4, 0xFF577222C14F0A3A,
+        0x55B6344CF97AAFAE, 0xB862225B055B6960, 0xCAC09AFBDDD2CDB4, 0xDAF8E9829FE96B5F,
+        0xB5FDFC5D3132C498, 0x310CB380DB6F7503, 0xE87FBB46217A360E, 0x2102AE466EBB1148,
+        0xF8549E1A3AA5E00D, 0x07A69AFDCC42261A, 0xC4C118BFE78FEAAE, 0xF9F4892ED96BD438,
+        0x1AF3DBE25D8F45DA, 0xF5B4B0B0D2DEEB92, 0x962ACEEFA82E1C84, 0x046E3ECAAF453CE9,
+        0xF05D129681949A4C, 0x964781CE734B3C84, 0x9C2ED44081CE5FBD, 0x522E23F3925E319E,
+        0x177E00F9FC32F791, 0x2BC60A63A6F3B3F2, 0x222BBFAE61725606, 0x486289DDCC3D6780,
+        0x7DC7785B8EFDFC80, 0x8AF38731C02BA980, 0x1FAB64EA29A2DDF7, 0xE4D9429322CD065A,
+        0x9DA058C67844F20C, 0x24C0E332B70019B0, 0x233003B5A6CFE6AD, 0xD586BD01C5C217F6,
+        0x5E5637885F29BC2B, 0x7EBA726D8C94094B, 0x0A56A5F0BFE39272, 0xD79476A84EE20D06,
+        0x9E4C1269BAA4BF37, 0x17EFEE45B0DEE640, 0x1D95B0A5FCF90BC6, 0x93CBE0B699C2585D,
+        0x65FA4F227A2B6D79, 0xD5F9E858292504D5, 0xC2B5A03F71471A6F, 0x59300222B4561E00,
+        0xCE2F8642CA0712DC, 0x7CA9723FBB2E8988, 0x2785338347F2BA08, 0xC61BB3A141E50E8C,
+        0x150F361DAB9DEC26, 0x9F6A419D382595F4, 0x64A53DC924FE7AC9, 0x142DE49FFF7A7C3D,
+        0x0C335248857FA9E7, 0x0A9C32D5EAE45305, 0xE6C42178C4BBB92E, 0x71F1CE2490D20B07,
+        0xF1BCC3D275AFE51A, 0xE728E8C83C334074, 0x96FBF83A12884624, 0x81A1549FD6573DA5,
+        0x5FA7867CAF35E149, 0x56986E2EF3ED091B, 0x917F1DD5F8886C61, 0xD20D8C88C8FFE65F,
+        0x31D71DCE64B2C310, 0xF165B587DF898190, 0xA57E6339DD2CF3A0, 0x1EF6E6DBB1961EC9,
+        0x70CC73D90BC26E24, 0xE21A6B35DF0C3AD7, 0x003A93D8B2806962, 0x1C99DED33CB890A1,
+        0xCF3145DE0ADD4289, 0xD0E4427A5514FB72, 0x77C621CC9FB3A483, 0x67A34DAC4356550B,
+        0xF8D626AAAF278509,
+    };
+    /*
+    The canonical PolyGlot ``Random64`` array: ``64 * kind + square`` for
+    piece placement with ``kind = (piece_type - 1) * 2 + color``, then
+    castling rights (768-771), en passant files (772-779) and the side to
+    move (780). Validated against the key test vectors of the PolyGlot
+    book format specification, so book keys match books built by other
+    PolyGlot tools.
+    */
+
     const std::regex SAN_REGEX(R"(^([NBKRQ])?([a-h])?([1-8])?[\-x]?([a-h][1-8])(=?[nbrqkNBRQK])?[\+#]?$)");
 
+    bool _san_tokens(const std::string &, char &, int &, int &, int &, int &, char &);
+
     const std::regex FEN_CASTLING_REGEX(R"(^(?:-|[KQABCDEFGH]{0,2}[kqabcdefgh]{0,2})$)");
 
+    bool _valid_castling_fen(std::string_view);
+
+    class _Chess960Setup
+    {
+        /* Back-rank file masks of one Chess960 starting arrangement. */
+
+    public:
+        unsigned char knights, bishops, rooks, queens, kings;
+    };
+
+    constexpr std::array<_Chess960Setup, 960> _chess960_table()
+    {
+        // See http://www.russellcottrell.com/Chess/Chess960.htm for
+        // a description of the algorithm.
+        std::array<_Chess960Setup, 960> table{};
+        for (int scharnagl = 0; scharnagl < 960; ++scharnagl)
+        {
+            int n = scharnagl / 4, bw = scharnagl % 4;
+            int bb = n % 4;
+            n /= 4;
+            int q = n % 6;
+            n /= 6;
+
+            int n1 = 0, n2 = 0;
+            for (n1 = 0; n1 < 4; ++n1)
+            {
+                n2 = n + (3 - n1) * (4 - n1) / 2 - 5;
+                if (n1 < n2 && 1 <= n2 && n2 <= 4)
+                {
+                    break;
+                }
+            }
+
+            _Chess960Setup &setup = table[scharnagl];
+
+            // Bishops.
+            int bw_file = bw * 2 + 1;
+            int bb_file = bb * 2;
+            setup.bishops = (1 << bw_file) | (1 << bb_file);
+
+            // Queens.
+            int q_file = q;
+            q_file += int(std::min(bw_file, bb_file) <= q_file);
+            q_file += int(std::max(bw_file, bb_file) <= q_file);
+            setup.queens = 1 << q_file;
+
+            bool used[8] = {};
+            used[bw_file] = used[bb_file] = used[q_file] = true;
+
+            // Knights.
+            setup.knights = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                if (!used[i])
+                {
+                    if (n1 == 0 || n2 == 0)
+                    {
+                        setup.knights |= 1 << i;
+                        used[i] = true;
+                    }
+                    --n1;
+                    --n2;
+                }
+            }
+
+            // RKR.
+            setup.rooks = setup.kings = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                if (!used[i])
+                {
+                    setup.rooks = 1 << i;
+                    used[i] = true;
+                    break;
+                }
+            }
+            for (int i = 1; i < 8; ++i)
+            {
+                if (!used[i])
+                {
+                    setup.kings = 1 << i;
+                    used[i] = true;
+                    break;
+                }
+            }
+            for (int i = 2; i < 8; ++i)
+            {
+                if (!used[i])
+                {
+                    setup.rooks |= 1 << i;
+                    break;
+                }
+            }
+        }
+        return table;
+    }
+
+    constexpr std::array<_Chess960Setup, 960> CHESS960_STARTING_POSITIONS = _chess960_table();
+
+    namespace stats
+    {
+        /*
+        Optional instrumentation for hot board operations. Define
+        ``CHESS_ENABLE_STATS`` at compile time to collect per-process
+        invocation counts and timestamp-counter ticks; without the flag
+        the hooks compile to nothing.
+        */
+
+        class Snapshot
+        {
+
+        public:
+            unsigned long long generate_legal_moves_calls, generate_legal_moves_ticks;
+            unsigned long long push_calls, push_ticks;
+            unsigned long long pop_calls, pop_ticks;
+            unsigned long long parse_san_calls, parse_san_ticks;
+            unsigned long long set_fen_calls, set_fen_ticks;
+            unsigned long long is_game_over_calls, is_game_over_ticks;
+            unsigned long long attack_lookups;
+        };
+
+        Snapshot snapshot();
+
+        void reset();
+
+#ifdef CHESS_ENABLE_STATS
+        class _Counter
+        {
+
+        public:
+            std::atomic<unsigned long long> calls, ticks;
+        };
+
+        class _Counters
+        {
+
+        public:
+            _Counter generate_legal_moves, push, pop, parse_san, set_fen, is_game_over;
+            std::atomic<unsigned long long> attack_lookups;
+        };
+
+        extern _Counters _counters;
+
+        unsigned long long _now();
+
+        class _Timer
+        {
+
+        public:
+            _Timer(_Counter &counter) : _counter(counter), _start(_now()) {}
+
+            ~_Timer()
+            {
+                this->_counter.calls.fetch_add(1, std::memory_order_relaxed);
+                this->_counter.ticks.fetch_add(_now() - this->_start, std::memory_order_relaxed);
+            }
+
+        private:
+            _Counter &_counter;
+            unsigned long long _start;
+        };
+#endif
+    }
+
+#ifdef CHESS_ENABLE_STATS
+#define _CHESS_STATS_SCOPE(op) stats::_Timer _chess_stats_timer(stats::_counters.op)
+#define _CHESS_STATS_COUNT(op) stats::_counters.op.fetch_add(1, std::memory_order_relaxed)
+#else
+#define _CHESS_STATS_SCOPE(op)
+#define _CHESS_STATS_COUNT(op)
+#endif
+
     class Piece
     {
         /* A piece with type and color. */
@@ -417,19 +1042,55 @@ namespace chess
 
         std::string uci() const;
 
+        unsigned short pack() const;
+
         std::string xboard() const;
 
         operator bool() const;
 
+        bool operator==(const Move &) const;
+
         operator std::string() const;
 
         static Move from_uci(const std::string &);
 
+        static Move unpack(unsigned short);
+
         static Move null();
     };
 
     std::ostream &operator<<(std::ostream &, const Move &);
 
+    class MoveInfo
+    {
+        /*
+        A legal move annotated with the ordering metadata the generator
+        already knows: the moving and captured piece types, and capture /
+        en passant / castling / check flags. See
+        :func:`chess::Board::generate_legal_moves_info()`.
+        */
+
+    public:
+        Move move = Move::null();
+
+        PieceType piece_type = PAWN;
+        /* The type of the moving (or dropped) piece. */
+
+        std::optional<PieceType> captured;
+        /* The type of the captured piece (``PAWN`` for en passant). */
+
+        bool is_capture = false;
+
+        bool is_en_passant = false;
+
+        bool is_castling = false;
+
+        bool gives_check = false;
+    };
+
+    template <typename Visitor, typename Payload>
+    bool _visit_move(Visitor &, const Payload &);
+
     class SquareSet;
 
     class BaseBoard
@@ -445,6 +1106,11 @@ namespace chess
 
     public:
         Bitboard occupied_co[2], pawns, knights, bishops, rooks, queens, kings, promoted, occupied;
+        Bitboard _hash_key;
+        /*
+        Zobrist key of the piece placement only, maintained incrementally.
+        Use :func:`chess::Board::zobrist_hash()` for a full position hash.
+        */
         BaseBoard(const std::optional<std::string> & = STARTING_BOARD_FEN);
 
         void reset_board();
@@ -465,6 +1131,12 @@ namespace chess
 
         Bitboard attacks_mask(Square) const;
 
+        void all_attacks(std::array<Bitboard, 64> &) const;
+
+        Bitboard color_attacks_mask(Color) const;
+
+        int mobility(Color) const;
+
         SquareSet attacks(Square) const;
 
         Bitboard attackers_mask(Color, Square) const;
@@ -531,6 +1203,10 @@ namespace chess
         void _set_piece_map(const std::unordered_map<Square, Piece> &);
 
         void _set_chess960_pos(int);
+
+        Bitboard _compute_hash_key() const;
+
+        void _piece_plane(unsigned char (&)[64]) const;
     };
 
     std::ostream &operator<<(std::ostream &, const BaseBoard &);
@@ -542,6 +1218,7 @@ namespace chess
 
     public:
         Bitboard pawns, knights, bishops, rooks, queens, kings, occupied_w, occupied_b, occupied, promoted;
+        Bitboard hash_key;
         Color turn;
         Bitboard castling_rights;
         std::optional<Square> ep_square;
@@ -680,6 +1357,10 @@ namespace chess
 
         void clear_stack();
 
+        void reserve_plies(int);
+
+        void reset_to(const Board &);
+
         Board root() const;
 
         int ply() const;
@@ -690,12 +1371,23 @@ namespace chess
 
         std::vector<Move> generate_pseudo_legal_moves(Bitboard = BB_ALL, Bitboard = BB_ALL) const;
 
+        template <typename Visitor>
+        void generate_pseudo_legal_moves(Bitboard, Bitboard, Visitor &&) const;
+
         std::vector<Move> generate_pseudo_legal_ep(Bitboard = BB_ALL, Bitboard = BB_ALL) const;
 
+        template <typename Visitor>
+        void generate_pseudo_legal_ep(Bitboard, Bitboard, Visitor &&) const;
+
         std::vector<Move> generate_pseudo_legal_captures(Bitboard = BB_ALL, Bitboard = BB_ALL) const;
 
+        template <typename Visitor>
+        void generate_pseudo_legal_captures(Bitboard, Bitboard, Visitor &&) const;
+
         Bitboard checkers_mask() const;
 
+        Bitboard zobrist_hash() const;
+
         SquareSet checkers() const;
 
         bool is_check() const;
@@ -724,6 +1416,8 @@ namespace chess
 
         std::optional<Outcome> outcome(bool = false);
 
+        bool has_any_legal_move() const;
+
         bool is_checkmate() const;
 
         bool is_stalemate() const;
@@ -766,7 +1460,13 @@ namespace chess
 
         std::string shredder_fen(_EnPassantSpec = "legal", std::optional<bool> = std::nullopt);
 
-        void set_fen(const std::string &);
+        void set_fen(std::string_view);
+
+        size_t fen_to(char *) const;
+
+        std::vector<unsigned char> to_bytes() const;
+
+        void set_bytes(const std::vector<unsigned char> &);
 
         void set_castling_fen(const std::string &);
 
@@ -776,6 +1476,8 @@ namespace chess
 
         void set_chess960_pos(int);
 
+        void reset_chess960(int);
+
         std::optional<int> chess960_pos(bool = false, bool = false, bool = true) const;
 
         std::string epd(bool = false, const _EnPassantSpec & = "legal", std::optional<bool> = std::nullopt, const std::unordered_map<std::string, std::variant<std::nullopt_t, std::string, int, float, Move, std::vector<Move>>> & = {});
@@ -792,6 +1494,8 @@ namespace chess
 
         Move parse_san(const std::string &);
 
+        std::optional<Move> try_parse_san(const std::string &) const;
+
         Move push_san(const std::string &);
 
         std::string uci(Move, std::optional<bool> = std::nullopt) const;
@@ -836,12 +1540,42 @@ namespace chess
 
         std::vector<Move> generate_legal_moves(Bitboard = BB_ALL, Bitboard = BB_ALL) const;
 
+        template <typename Visitor>
+        void generate_legal_moves(Bitboard, Bitboard, Visitor &&) const;
+
         std::vector<Move> generate_legal_ep(Bitboard = BB_ALL, Bitboard = BB_ALL) const;
 
+        template <typename Visitor>
+        void generate_legal_ep(Bitboard, Bitboard, Visitor &&) const;
+
         std::vector<Move> generate_legal_captures(Bitboard = BB_ALL, Bitboard = BB_ALL) const;
 
+        template <typename Visitor>
+        void generate_legal_captures(Bitboard, Bitboard, Visitor &&) const;
+
         std::vector<Move> generate_castling_moves(Bitboard = BB_ALL, Bitboard = BB_ALL) const;
 
+        template <typename Visitor>
+        void generate_castling_moves(Bitboard, Bitboard, Visitor &&) const;
+
+        std::vector<MoveInfo> generate_legal_moves_info(Bitboard = BB_ALL, Bitboard = BB_ALL) const;
+
+        template <typename Visitor>
+        void generate_legal_moves_info(Bitboard, Bitboard, Visitor &&) const;
+
+        template <typename Visitor>
+        void generate_captures(Visitor &&) const;
+
+        template <typename Visitor>
+        void generate_checks(Visitor &&) const;
+
+        template <typename Visitor>
+        void generate_quiets(Visitor &&) const;
+
+        unsigned long long perft(int);
+
+        std::vector<std::tuple<Move, unsigned long long>> perft_divide(int);
+
         bool operator==(const Board &) const;
 
         void apply_transform(const std::function<Bitboard(Bitboard)> &);
@@ -858,11 +1592,35 @@ namespace chess
 
         static std::tuple<Board, std::unordered_map<std::string, std::variant<std::nullopt_t, std::string, int, float, Move, std::vector<Move>>>> from_epd(const std::string &, bool = false);
 
+        static Board from_bytes(const std::vector<unsigned char> &);
+
         static Board from_chess960_pos(int);
 
     private:
         std::vector<_BoardState> _stack;
 
+        class _LegalityContext
+        {
+            /*
+            Attack and pin state of the current position -- the king
+            square, its slider blockers and the checkers mask -- cached on
+            first use and revalidated against the position key, so any
+            mutation (including direct writes to public fields)
+            transparently discards it.
+            */
+
+        public:
+            Bitboard hash_key, occupied;
+            Color turn;
+
+            std::optional<Square> king;
+            Bitboard blockers, checkers;
+        };
+
+        mutable std::optional<_LegalityContext> _legality_cache;
+
+        const _LegalityContext &_legality_context() const;
+
         bool _is_halfmoves(int) const;
 
         _BoardState _board_state() const;
@@ -875,6 +1633,18 @@ namespace chess
 
         std::unordered_map<std::string, std::variant<std::nullopt_t, std::string, int, float, Move, std::vector<Move>>> _parse_epd_ops(const std::string &, const std::function<Board()> &) const;
 
+        enum class _ParseSanStatus
+        {
+            OK,
+            INVALID,
+            ILLEGAL,
+            AMBIGUOUS,
+            MULTI_LEG,
+            MISSING_PROMOTION
+        };
+
+        _ParseSanStatus _parse_san(const std::string &, Move &) const;
+
         std::string _algebraic(const Move &, bool = false);
 
         std::string _algebraic_and_push(const Move &, bool = false);
@@ -891,8 +1661,25 @@ namespace chess
 
         bool _is_safe(Square, Bitboard, const Move &) const;
 
+        bool _move_gives_check(const Move &) const;
+
         std::vector<Move> _generate_evasions(Square, Bitboard, Bitboard = BB_ALL, Bitboard = BB_ALL) const;
 
+        template <typename Visitor>
+        bool _visit_pseudo_legal_moves(Bitboard, Bitboard, Visitor &) const;
+
+        template <typename Visitor>
+        bool _visit_pseudo_legal_ep(Bitboard, Bitboard, Visitor &) const;
+
+        template <typename Visitor>
+        bool _visit_castling_moves(Bitboard, Bitboard, Visitor &) const;
+
+        template <typename Visitor>
+        bool _visit_evasions(Square, Bitboard, Bitboard, Bitboard, Visitor &) const;
+
+        template <typename Visitor>
+        bool _visit_legal_moves(Bitboard, Bitboard, Visitor &) const;
+
         bool _attacked_for_king(Bitboard, Bitboard) const;
 
         Move _from_chess960(bool, Square, Square, std::optional<PieceType> = std::nullopt, std::optional<PieceType> = std::nullopt) const;
@@ -904,8 +1691,88 @@ namespace chess
 
     std::ostream &operator<<(std::ostream &, Board);
 
+    template <typename F>
+    void batch_process(const std::vector<std::string> &, F &&, int = 0);
+
+    class TaskPool
+    {
+        /*
+        A small work-stealing thread pool for parallel game-tree walks.
+
+        Each worker owns a deque: tasks submitted from inside a worker go
+        to its own deque (popped newest-first for locality), and idle
+        workers steal oldest-first from the others. Use
+        :func:`~chess::TaskPool::wait()` to join on all submitted work.
+        */
+
+    public:
+        TaskPool(int = 0);
+
+        ~TaskPool();
+
+        void submit(std::function<void()>);
+
+        void wait();
+
+        int size() const;
+
+    private:
+        class _Worker
+        {
+
+        public:
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<_Worker>> _workers;
+        std::vector<std::thread> _threads;
+        std::atomic<int> _pending;
+        std::atomic<bool> _stop;
+        std::mutex _mutex;
+        std::condition_variable _work_ready, _all_done;
+
+        bool _try_run(int);
+
+        void _run(int);
+    };
+
+    unsigned long long parallel_perft(const Board &, int, int = 0);
+
+    class BoardPool
+    {
+        /*
+        A thread-safe pool of reusable boards for shared-nothing worker
+        flows (acquire -> set position -> work -> release). Released
+        boards keep the capacity of their move and snapshot stacks, so a
+        warm pool serves positions without allocating.
+        */
+
+    public:
+        BoardPool(int = 0);
+
+        Board *acquire();
+
+        void release(Board *);
+
+        size_t size();
+
+    private:
+        std::mutex _mutex;
+        std::vector<std::unique_ptr<Board>> _boards;
+        std::vector<Board *> _free;
+    };
+
     class PseudoLegalMoveGenerator
     {
+        /*
+        A lazy view over the pseudo-legal moves of a board.
+
+        The board is referenced, not copied; the generator must not outlive
+        it. Moves are only generated when first iterated or counted, and
+        ``operator bool`` probes for a first move without generating the
+        rest.
+        */
 
     public:
         PseudoLegalMoveGenerator(const Board &);
@@ -914,23 +1781,33 @@ namespace chess
 
         int count() const;
 
-        auto begin() const;
+        std::vector<Move>::const_iterator begin() const;
 
-        auto end() const;
+        std::vector<Move>::const_iterator end() const;
 
         Board get_board() const;
 
         operator std::vector<Move>() const;
 
     private:
-        Board _board;
-        std::vector<Move> _iter;
+        const Board *_board;
+        mutable std::optional<std::vector<Move>> _iter;
+
+        const std::vector<Move> &_moves() const;
     };
 
     std::ostream &operator<<(std::ostream &, PseudoLegalMoveGenerator);
 
     class LegalMoveGenerator
     {
+        /*
+        A lazy view over the legal moves of a board.
+
+        The board is referenced, not copied; the generator must not outlive
+        it. Moves are only generated when first iterated or counted, and
+        ``operator bool`` probes for a first move without generating the
+        rest.
+        */
 
     public:
         LegalMoveGenerator(const Board &);
@@ -939,17 +1816,19 @@ namespace chess
 
         int count() const;
 
-        auto begin() const;
+        std::vector<Move>::const_iterator begin() const;
 
-        auto end() const;
+        std::vector<Move>::const_iterator end() const;
 
         Board get_board() const;
 
         operator std::vector<Move>() const;
 
     private:
-        Board _board;
-        std::vector<Move> _iter;
+        const Board *_board;
+        mutable std::optional<std::vector<Move>> _iter;
+
+        const std::vector<Move> &_moves() const;
     };
 
     std::ostream &operator<<(std::ostream &, LegalMoveGenerator);
@@ -1044,9 +1923,9 @@ namespace chess
 
         // Set
 
-        std::vector<Square>::const_iterator begin() const;
+        _ScanForward::iterator begin() const;
 
-        std::vector<Square>::const_iterator end() const;
+        _ScanForward::iterator end() const;
 
         size_t size() const;
 
@@ -1148,7 +2027,6 @@ namespace chess
 
     private:
         Bitboard _mask;
-        std::vector<Square> _iter;
     };
 
     std::ostream &operator<<(std::ostream &, const SquareSet &);
@@ -0,0 +1,363 @@
+/*
+This is a line-for-line remake of niklasf's 'python-chess' in C++
+All credit for the original code and algorithms go to niklasf and his credits
+The original source code can be found here: https://github.com/niklasf/python-chess
+*/
+
+#include "engine.h"
+
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace chess
+{
+    UciEngine::UciEngine(const std::string &command)
+    {
+        /*
+        Spawns the engine with ``/bin/sh -c command``. Call
+        :func:`~chess::UciEngine::initialize()` for the ``uci`` handshake.
+
+        :throws: :exc:`std::runtime_error` if the process cannot be spawned.
+        */
+        int to_child[2], from_child[2];
+        if (pipe(to_child) || pipe(from_child))
+        {
+            throw std::runtime_error("could not create engine pipes");
+        }
+
+        this->_pid = fork();
+        if (this->_pid < 0)
+        {
+            throw std::runtime_error("could not fork engine process");
+        }
+
+        if (this->_pid == 0)
+        {
+            dup2(to_child[0], 0);
+            dup2(from_child[1], 1);
+            close(to_child[0]);
+            close(to_child[1]);
+            close(from_child[0]);
+            close(from_child[1]);
+            execl("/bin/sh", "sh", "-c", command.c_str(), (char *)nullptr);
+            _exit(127);
+        }
+
+        close(to_child[0]);
+        close(from_child[1]);
+        this->_in_fd = from_child[0];
+        this->_out_fd = to_child[1];
+        fcntl(this->_in_fd, F_SETFL, fcntl(this->_in_fd, F_GETFL) | O_NONBLOCK);
+
+        // Writing to a crashed engine must not kill the host with
+        // SIGPIPE; send_line() surfaces the EPIPE instead.
+        signal(SIGPIPE, SIG_IGN);
+
+        this->_searching = false;
+    }
+
+    UciEngine::~UciEngine()
+    {
+        this->quit();
+    }
+
+    void UciEngine::quit()
+    {
+        /* Asks the engine to quit and reaps the process. */
+        if (this->_pid <= 0)
+        {
+            return;
+        }
+        this->send_line("quit");
+        close(this->_out_fd);
+        close(this->_in_fd);
+        waitpid(this->_pid, nullptr, 0);
+        this->_pid = -1;
+    }
+
+    void UciEngine::send_line(const std::string &line)
+    {
+        std::string data = line + "\n";
+        size_t written = 0;
+        while (written < data.length())
+        {
+            ssize_t n = write(this->_out_fd, data.data() + written, data.length() - written);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                // Engine died (EPIPE with SIGPIPE ignored); reads will run
+                // dry and surface it.
+                return;
+            }
+            written += n;
+        }
+    }
+
+    bool UciEngine::_fill_buffer()
+    {
+        char chunk[4096];
+        ssize_t n = read(this->_in_fd, chunk, sizeof(chunk));
+        if (n > 0)
+        {
+            this->_buffer.append(chunk, n);
+            return true;
+        }
+        return false;
+    }
+
+    std::optional<std::string> UciEngine::read_line()
+    {
+        /*
+        Returns the next complete line of engine output, or
+        ``std::nullopt`` if none is available yet. Never blocks.
+        */
+        while (true)
+        {
+            size_t newline = this->_buffer.find('\n');
+            if (newline != std::string::npos)
+            {
+                std::string line = this->_buffer.substr(0, newline);
+                this->_buffer.erase(0, newline + 1);
+                if (!line.empty() && line.back() == '\r')
+                {
+                    line.pop_back();
+                }
+                return line;
+            }
+            if (!this->_fill_buffer())
+            {
+                return std::nullopt;
+            }
+        }
+    }
+
+    int UciEngine::fd() const
+    {
+        /* The file descriptor of the engine's output, for polling. */
+        return this->_in_fd;
+    }
+
+    bool UciEngine::searching() const
+    {
+        return this->_searching;
+    }
+
+    void UciEngine::_wait_for(const std::string &token)
+    {
+        struct pollfd pfd = {this->_in_fd, POLLIN, 0};
+        while (true)
+        {
+            std::optional<std::string> line = this->read_line();
+            if (line == std::nullopt)
+            {
+                if (poll(&pfd, 1, -1) < 0 || pfd.revents & (POLLERR | POLLHUP))
+                {
+                    if (this->read_line() == std::nullopt)
+                    {
+                        throw std::runtime_error("engine terminated while waiting for \"" + token + "\"");
+                    }
+                }
+                continue;
+            }
+            if (*line == token || line->compare(0, token.length() + 1, token + " ") == 0)
+            {
+                return;
+            }
+            if (line->compare(0, 8, "id name ") == 0)
+            {
+                this->name = line->substr(8);
+            }
+            else if (line->compare(0, 10, "id author ") == 0)
+            {
+                this->author = line->substr(10);
+            }
+        }
+    }
+
+    void UciEngine::initialize()
+    {
+        /* Performs the ``uci`` handshake and waits for ``uciok``. */
+        this->send_line("uci");
+        this->_wait_for("uciok");
+    }
+
+    void UciEngine::set_option(const std::string &name, const std::string &value)
+    {
+        this->send_line("setoption name " + name + " value " + value);
+    }
+
+    void UciEngine::new_game()
+    {
+        /* Sends ``ucinewgame`` and synchronizes with ``isready``. */
+        this->send_line("ucinewgame");
+        this->send_line("isready");
+        this->_wait_for("readyok");
+    }
+
+    void UciEngine::analyse_async(Board &board, int depth, int movetime)
+    {
+        /*
+        Sends the position and starts a search without waiting for the
+        result. Pass a *depth* or a *movetime* in milliseconds (or neither
+        for the engine's default). Collect the result with
+        :func:`~chess::UciEngine::poll_result()`.
+        */
+        this->send_line("position fen " + board.fen());
+        if (depth)
+        {
+            this->send_line("go depth " + std::to_string(depth));
+        }
+        else if (movetime)
+        {
+            this->send_line("go movetime " + std::to_string(movetime));
+        }
+        else
+        {
+            this->send_line("go");
+        }
+        this->_pending = AnalysisResult();
+        this->_searching = true;
+    }
+
+    void UciEngine::_parse_info(const std::string &line)
+    {
+        std::istringstream iss(line);
+        std::string token;
+        iss >> token; // "info"
+        while (iss >> token)
+        {
+            if (token == "depth")
+            {
+                int depth;
+                if (iss >> depth)
+                {
+                    this->_pending.depth = depth;
+                }
+            }
+            else if (token == "score")
+            {
+                std::string kind;
+                int value;
+                if (iss >> kind >> value)
+                {
+                    if (kind == "cp")
+                    {
+                        this->_pending.score_cp = value;
+                        this->_pending.score_mate = std::nullopt;
+                    }
+                    else if (kind == "mate")
+                    {
+                        this->_pending.score_mate = value;
+                        this->_pending.score_cp = std::nullopt;
+                    }
+                }
+            }
+            else if (token == "pv")
+            {
+                this->_pending.pv.clear();
+                while (iss >> token)
+                {
+                    this->_pending.pv.push_back(token);
+                }
+            }
+        }
+    }
+
+    std::optional<AnalysisResult> UciEngine::poll_result()
+    {
+        /*
+        Consumes any available engine output. Returns the
+        :class:`~chess::AnalysisResult` once ``bestmove`` has arrived,
+        ``std::nullopt`` while the engine is still thinking. Never blocks.
+        */
+        if (!this->_searching)
+        {
+            return std::nullopt;
+        }
+
+        while (std::optional<std::string> line = this->read_line())
+        {
+            if (line->compare(0, 5, "info ") == 0)
+            {
+                this->_parse_info(*line);
+            }
+            else if (line->compare(0, 9, "bestmove ") == 0)
+            {
+                std::istringstream iss(*line);
+                std::string token, best, ponder;
+                iss >> token >> best;
+                this->_pending.best_move = best == "(none)" ? std::nullopt : std::optional(Move::from_uci(best));
+                if (iss >> token >> ponder && token == "ponder")
+                {
+                    this->_pending.ponder = Move::from_uci(ponder);
+                }
+                this->_searching = false;
+                return this->_pending;
+            }
+        }
+        return std::nullopt;
+    }
+
+    AnalysisResult UciEngine::analyse(Board &board, int depth, int movetime)
+    {
+        /*
+        Blocking convenience wrapper: starts a search and polls until the
+        ``bestmove`` arrives.
+        */
+        this->analyse_async(board, depth, movetime);
+        struct pollfd pfd = {this->_in_fd, POLLIN, 0};
+        while (true)
+        {
+            std::optional<AnalysisResult> result = this->poll_result();
+            if (result)
+            {
+                return *result;
+            }
+            if (poll(&pfd, 1, -1) < 0 || pfd.revents & (POLLERR | POLLHUP))
+            {
+                std::optional<AnalysisResult> last = this->poll_result();
+                if (last)
+                {
+                    return *last;
+                }
+                throw std::runtime_error("engine terminated during search");
+            }
+        }
+    }
+
+    std::vector<UciEngine *> poll_engines(const std::vector<UciEngine *> &engines, int timeout_ms)
+    {
+        /*
+        Waits until at least one of *engines* has output to read (or the
+        timeout in milliseconds elapses; pass ``-1`` to wait forever) and
+        returns the readable ones. The multiplexing loop for driving many
+        engines from a single thread.
+        */
+        std::vector<struct pollfd> pfds;
+        for (UciEngine *engine : engines)
+        {
+            pfds.push_back({engine->fd(), POLLIN, 0});
+        }
+
+        std::vector<UciEngine *> ready;
+        if (poll(pfds.data(), pfds.size(), timeout_ms) <= 0)
+        {
+            return ready;
+        }
+        for (size_t i = 0; i < engines.size(); ++i)
+        {
+            if (pfds[i].revents & (POLLIN | POLLHUP))
+            {
+                ready.push_back(engines[i]);
+            }
+        }
+        return ready;
+    }
+}
@@ -0,0 +1,91 @@
+/*
+This is a line-for-line remake of niklasf's 'python-chess' in C++
+All credit for the original code and algorithms go to niklasf and his credits
+The original source code can be found here: https://github.com/niklasf/python-chess
+*/
+
+#include "chess.cpp"
+
+namespace chess
+{
+    class AnalysisResult
+    {
+        /*
+        The result of a completed ``go`` command: the best move, the
+        optional ponder move, and the fields of the last ``info`` line
+        (depth, score and principal variation in UCI notation).
+        */
+
+    public:
+        std::optional<Move> best_move;
+
+        std::optional<Move> ponder;
+
+        std::optional<int> depth;
+
+        std::optional<int> score_cp;
+
+        std::optional<int> score_mate;
+
+        std::vector<std::string> pv;
+    };
+
+    class UciEngine
+    {
+        /*
+        A UCI engine process with non-blocking I/O.
+
+        The engine's standard output is read without blocking, so many
+        engines can be multiplexed on one thread: start an analysis with
+        :func:`~chess::UciEngine::analyse_async()`, wait for readable
+        engines with :func:`chess::poll_engines()` and collect finished
+        results with :func:`~chess::UciEngine::poll_result()`.
+        */
+
+    public:
+        UciEngine(const std::string &);
+
+        ~UciEngine();
+
+        void initialize();
+
+        void set_option(const std::string &, const std::string &);
+
+        void new_game();
+
+        void analyse_async(Board &, int = 0, int = 0);
+
+        std::optional<AnalysisResult> poll_result();
+
+        AnalysisResult analyse(Board &, int = 0, int = 0);
+
+        void send_line(const std::string &);
+
+        std::optional<std::string> read_line();
+
+        int fd() const;
+
+        bool searching() const;
+
+        std::string name;
+
+        std::string author;
+
+        void quit();
+
+    private:
+        int _pid;
+        int _in_fd, _out_fd;
+        std::string _buffer;
+        bool _searching;
+        AnalysisResult _pending;
+
+        bool _fill_buffer();
+
+        void _wait_for(const std::string &);
+
+        void _parse_info(const std::string &);
+    };
+
+    std::vector<UciEngine *> poll_engines(const std::vector<UciEngine *> &, int);
+}
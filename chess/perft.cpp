@@ -0,0 +1,63 @@
+#include "chess.cpp"
+#include <chrono>
+#include <iostream>
+
+int main(int argc, char *argv[]) {
+    // With a FEN and depth given, print the divide output for that
+    // position. Otherwise run the standard perft suite and report
+    // nodes/sec as a move generation regression gate.
+    if (argc >= 3) {
+        chess::Board board{std::string(argv[1])};
+        int depth = std::stoi(argv[2]);
+
+        unsigned long long total = 0;
+        for (auto [move, nodes] : board.perft_divide(depth)) {
+            std::cout << move.uci() << ": " << nodes << std::endl;
+            total += nodes;
+        }
+        std::cout << "total: " << total << std::endl;
+        return 0;
+    }
+
+    struct {
+        std::string name, fen;
+        int depth;
+        unsigned long long nodes;
+    } suite[] = {
+        {"startpos", chess::STARTING_FEN, 5, 4865609},
+        {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+        {"position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+        {"position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+        {"position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+        {"position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+    };
+
+    unsigned long long total_nodes = 0;
+    long long total_ms = 0;
+    bool ok = true;
+
+    for (auto &entry : suite) {
+        chess::Board board{entry.fen};
+        board.reserve_plies(entry.depth);
+
+        auto start = std::chrono::steady_clock::now();
+        unsigned long long nodes = board.perft(entry.depth);
+        auto stop = std::chrono::steady_clock::now();
+
+        long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+        total_nodes += nodes;
+        total_ms += ms;
+
+        std::cout << entry.name << ": depth " << entry.depth << ", " << nodes << " nodes, " << ms << " ms";
+        if (nodes != entry.nodes) {
+            std::cout << " -- MISMATCH, expected " << entry.nodes;
+            ok = false;
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "total: " << total_nodes << " nodes, " << total_ms << " ms, "
+              << (total_ms ? total_nodes * 1000 / total_ms : 0) << " nodes/sec" << std::endl;
+
+    return ok ? 0 : 1;
+}
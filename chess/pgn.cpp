@@ -0,0 +1,253 @@
+/*
+This is a line-for-line remake of niklasf's 'python-chess' in C++
+All credit for the original code and algorithms go to niklasf and his credits
+The original source code can be found here: https://github.com/niklasf/python-chess
+*/
+
+#include "pgn.h"
+
+namespace chess
+{
+    std::optional<std::string> PgnGame::header(const std::string &key) const
+    {
+        /* Gets the value of the first header with the given tag name. */
+        for (const auto &[name, value] : this->headers)
+        {
+            if (name == key)
+            {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void PgnGame::clear()
+    {
+        this->headers.clear();
+        this->moves.clear();
+        this->result = "*";
+    }
+
+    PgnReader::PgnReader(std::istream &stream)
+    {
+        this->_stream = &stream;
+        this->_have_line = false;
+    }
+
+    bool PgnReader::_next_line()
+    {
+        while (std::getline(*this->_stream, this->_line))
+        {
+            // Strip trailing carriage returns and skip escaped lines.
+            if (!this->_line.empty() && this->_line.back() == '\r')
+            {
+                this->_line.pop_back();
+            }
+            if (!this->_line.empty() && this->_line.front() == '%')
+            {
+                continue;
+            }
+            this->_have_line = true;
+            return true;
+        }
+        this->_have_line = false;
+        return false;
+    }
+
+    bool PgnReader::_parse_headers(PgnGame &game, Board &board)
+    {
+        // Skip blank lines before the game.
+        while (!this->_have_line || this->_line.empty())
+        {
+            if (!this->_next_line())
+            {
+                return false;
+            }
+        }
+
+        while (this->_have_line && !this->_line.empty() && this->_line.front() == '[')
+        {
+            // [Key "Value"]
+            size_t key_end = this->_line.find(' ');
+            size_t value_begin = this->_line.find('"');
+            size_t value_end = this->_line.rfind('"');
+            if (key_end != std::string::npos && value_begin != std::string::npos && value_end > value_begin)
+            {
+                game.headers.push_back({this->_line.substr(1, key_end - 1),
+                                        this->_line.substr(value_begin + 1, value_end - value_begin - 1)});
+            }
+            this->_next_line();
+        }
+
+        std::optional<std::string> fen = game.header("FEN");
+        if (fen)
+        {
+            board.set_fen(*fen);
+        }
+        else
+        {
+            board.reset();
+            board.clear_stack();
+        }
+        return true;
+    }
+
+    bool PgnReader::_parse_movetext(PgnGame &game, Board &board)
+    {
+        int variation_depth = 0;
+        bool in_comment = false;
+
+        // Skip the blank line(s) between the headers and the movetext.
+        while (this->_have_line && this->_line.empty())
+        {
+            if (!this->_next_line())
+            {
+                return true;
+            }
+        }
+
+        while (true)
+        {
+            if (!this->_have_line || (this->_line.empty() && !in_comment))
+            {
+                return true; // Game ends at end of input or a blank line.
+            }
+
+            size_t i = 0, length = this->_line.length();
+            while (i < length)
+            {
+                char c = this->_line[i];
+
+                if (in_comment)
+                {
+                    in_comment = this->_line[i] != '}';
+                    ++i;
+                    continue;
+                }
+
+                if (c == ' ' || c == '\t' || c == '.')
+                {
+                    ++i;
+                }
+                else if (c == '{')
+                {
+                    in_comment = true;
+                    ++i;
+                }
+                else if (c == ';')
+                {
+                    break; // Rest-of-line comment.
+                }
+                else if (c == '(')
+                {
+                    ++variation_depth;
+                    ++i;
+                }
+                else if (c == ')')
+                {
+                    --variation_depth;
+                    ++i;
+                }
+                else if (c == '$')
+                {
+                    // Numeric annotation glyph.
+                    for (++i; i < length && std::isdigit(this->_line[i]); ++i)
+                        ;
+                }
+                else
+                {
+                    // A move number, a termination marker or a SAN token.
+                    size_t begin = i;
+                    while (i < length && this->_line[i] != ' ' && this->_line[i] != '\t' && this->_line[i] != '.' &&
+                           this->_line[i] != '{' && this->_line[i] != ';' && this->_line[i] != '(' && this->_line[i] != ')')
+                    {
+                        ++i;
+                    }
+                    std::string token = this->_line.substr(begin, i - begin);
+
+                    // Strip suffix annotations like "!?".
+                    while (token.length() > 1 && (token.back() == '!' || token.back() == '?'))
+                    {
+                        token.pop_back();
+                    }
+
+                    if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*")
+                    {
+                        game.result = token;
+                        this->_next_line();
+                        return true;
+                    }
+                    if (std::isdigit(token.front()) && token.compare(0, 3, "0-0") != 0)
+                    {
+                        continue; // Move number.
+                    }
+                    if (variation_depth)
+                    {
+                        continue; // Moves inside a variation are skipped.
+                    }
+
+                    std::optional<Move> move = board.try_parse_san(token);
+                    if (move == std::nullopt)
+                    {
+                        throw std::invalid_argument("invalid san in pgn: \"" + token + "\"");
+                    }
+                    board.push(*move);
+                    game.moves.push_back(*move);
+                }
+            }
+
+            if (!this->_next_line())
+            {
+                return true;
+            }
+        }
+    }
+
+    bool PgnReader::read_game(PgnGame &game, Board &board)
+    {
+        /*
+        Reads the next game from the stream.
+
+        *game* is cleared and refilled; *board* is reset (or set up from the
+        game's FEN header) and ends up at the final position of the
+        mainline. Returns ``false`` once the stream is exhausted.
+        */
+        game.clear();
+        if (!this->_parse_headers(game, board))
+        {
+            return false;
+        }
+        return this->_parse_movetext(game, board);
+    }
+
+    bool PgnReader::skip_game()
+    {
+        /*
+        Skips the next game without replaying its moves. Returns ``false``
+        once the stream is exhausted.
+        */
+        // Skip blank lines, then the header section.
+        while (!this->_have_line || this->_line.empty())
+        {
+            if (!this->_next_line())
+            {
+                return false;
+            }
+        }
+        while (this->_have_line && !this->_line.empty() && this->_line.front() == '[')
+        {
+            this->_next_line();
+        }
+        // Skip the blank line(s) between the headers and the movetext, then
+        // the movetext itself up to the next blank line.
+        while (this->_have_line && this->_line.empty())
+        {
+            this->_next_line();
+        }
+        while (this->_have_line && !this->_line.empty())
+        {
+            this->_next_line();
+        }
+        return true;
+    }
+}
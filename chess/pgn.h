@@ -0,0 +1,64 @@
+/*
+This is a line-for-line remake of niklasf's 'python-chess' in C++
+All credit for the original code and algorithms go to niklasf and his credits
+The original source code can be found here: https://github.com/niklasf/python-chess
+*/
+
+#include "chess.cpp"
+
+#include <istream>
+
+namespace chess
+{
+    class PgnGame
+    {
+        /*
+        A single game read from a PGN stream: its headers in file order,
+        the mainline moves, and the game termination marker.
+        */
+
+    public:
+        std::vector<std::pair<std::string, std::string>> headers;
+
+        std::vector<Move> moves;
+
+        std::string result;
+        /* The termination marker (``1-0``, ``0-1``, ``1/2-1/2`` or ``*``). */
+
+        std::optional<std::string> header(const std::string &) const;
+
+        void clear();
+    };
+
+    class PgnReader
+    {
+        /*
+        A streaming PGN pull-parser.
+
+        Games are read one at a time with
+        :func:`~chess::PgnReader::read_game()` into a caller-provided
+        :class:`~chess::PgnGame` and a reusable :class:`~chess::Board`, so a
+        multi-gigabyte database can be replayed without per-game
+        allocations. Tokens are sliced out of the internal line buffer;
+        comments, variations and NAGs are skipped.
+        */
+
+    public:
+        PgnReader(std::istream &);
+
+        bool read_game(PgnGame &, Board &);
+
+        bool skip_game();
+
+    private:
+        std::istream *_stream;
+        std::string _line;
+        bool _have_line;
+
+        bool _next_line();
+
+        bool _parse_headers(PgnGame &, Board &);
+
+        bool _parse_movetext(PgnGame &, Board &);
+    };
+}
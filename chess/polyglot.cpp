@@ -0,0 +1,242 @@
+/*
+This is a line-for-line remake of niklasf's 'python-chess' in C++
+All credit for the original code and algorithms go to niklasf and his credits
+The original source code can be found here: https://github.com/niklasf/python-chess
+*/
+
+#include "polyglot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chess
+{
+    const size_t _BOOK_ENTRY_SIZE = 16;
+
+    Bitboard polyglot_key(const Board &board)
+    {
+        /*
+        Gets the canonical PolyGlot hash of the position.
+
+        Identical to :func:`chess::Board::zobrist_hash()` except for the
+        en passant rule: PolyGlot includes the en passant file whenever a
+        pawn of the side to move stands beside the double-pushed pawn
+        (it could pseudo-legally capture), regardless of pins.
+        */
+        Bitboard key = board._hash_key;
+
+        Bitboard castling_rights = board.clean_castling_rights();
+        if (castling_rights & BB_H1)
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[768];
+        }
+        if (castling_rights & BB_A1)
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[769];
+        }
+        if (castling_rights & BB_H8)
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[770];
+        }
+        if (castling_rights & BB_A8)
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[771];
+        }
+
+        if (board.has_pseudo_legal_en_passant())
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[772 + square_file(*board.ep_square)];
+        }
+
+        if (board.turn == WHITE)
+        {
+            key ^= ZOBRIST_RANDOM_ARRAY[780];
+        }
+
+        return key;
+    }
+
+    Move BookEntry::move(const Board &board) const
+    {
+        /*
+        Decodes the raw move in the context of *board*. Polyglot encodes
+        castling as king-takes-rook; it is normalized for non-Chess960
+        boards.
+        */
+        int to_file = this->raw_move & 0x7;
+        int to_rank = this->raw_move >> 3 & 0x7;
+        int from_file = this->raw_move >> 6 & 0x7;
+        int from_rank = this->raw_move >> 9 & 0x7;
+        int promotion_part = this->raw_move >> 12 & 0x7;
+
+        Square from_square = square(from_file, from_rank);
+        Square to_square = square(to_file, to_rank);
+        std::optional<PieceType> promotion = promotion_part ? std::optional(promotion_part + 1) : std::nullopt;
+
+        // Convert king-takes-rook castling to the board's encoding.
+        if (!board.chess960 && promotion == std::nullopt && board.kings & BB_SQUARES[from_square] &&
+            board.occupied_co[board.turn] & board.rooks & BB_SQUARES[to_square])
+        {
+            to_square = square(square_file(to_square) > square_file(from_square) ? 6 : 2, from_rank);
+        }
+
+        return Move(from_square, to_square, promotion);
+    }
+
+    BookReader::BookReader(const std::string &path)
+    {
+        /*
+        Memory-maps the book read-only and shared, so concurrent worker
+        processes share its pages through the page cache.
+
+        :throws: :exc:`std::runtime_error` if the book cannot be mapped.
+        */
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("could not open book: \"" + path + "\"");
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) < 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("could not stat book: \"" + path + "\"");
+        }
+
+        void *mapping = mmap(nullptr, std::max<off_t>(st.st_size, 1), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            throw std::runtime_error("could not mmap book: \"" + path + "\"");
+        }
+
+        this->_data = (const unsigned char *)mapping;
+        this->_size = st.st_size / _BOOK_ENTRY_SIZE;
+    }
+
+    BookReader::~BookReader()
+    {
+        this->close();
+    }
+
+    void BookReader::close()
+    {
+        if (this->_data)
+        {
+            munmap((void *)this->_data, std::max<size_t>(this->_size * _BOOK_ENTRY_SIZE, 1));
+            this->_data = nullptr;
+            this->_size = 0;
+        }
+    }
+
+    size_t BookReader::size() const
+    {
+        /* The number of entries in the book. */
+        return this->_size;
+    }
+
+    BookEntry BookReader::entry_at(size_t index) const
+    {
+        const unsigned char *raw = this->_data + index * _BOOK_ENTRY_SIZE;
+
+        BookEntry entry;
+        entry.key = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            entry.key = entry.key << 8 | raw[i];
+        }
+        entry.raw_move = raw[8] << 8 | raw[9];
+        entry.weight = raw[10] << 8 | raw[11];
+        entry.learn = (unsigned int)raw[12] << 24 | raw[13] << 16 | raw[14] << 8 | raw[15];
+        return entry;
+    }
+
+    size_t BookReader::_lower_bound(Bitboard key) const
+    {
+        size_t lo = 0, hi = this->_size;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (this->entry_at(mid).key < key)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    std::vector<BookEntry> BookReader::find_all(const Board &board) const
+    {
+        /* Gets all entries for the position, in book order. */
+        std::vector<BookEntry> entries;
+        Bitboard key = polyglot_key(board);
+        for (size_t i = this->_lower_bound(key); i < this->_size; ++i)
+        {
+            BookEntry entry = this->entry_at(i);
+            if (entry.key != key)
+            {
+                break;
+            }
+            entries.push_back(entry);
+        }
+        return entries;
+    }
+
+    std::optional<BookEntry> BookReader::find(const Board &board) const
+    {
+        /* Gets the highest-weighted entry for the position, if any. */
+        std::optional<BookEntry> best;
+        Bitboard key = polyglot_key(board);
+        for (size_t i = this->_lower_bound(key); i < this->_size; ++i)
+        {
+            BookEntry entry = this->entry_at(i);
+            if (entry.key != key)
+            {
+                break;
+            }
+            if (best == std::nullopt || entry.weight > best->weight)
+            {
+                best = entry;
+            }
+        }
+        return best;
+    }
+
+    std::vector<std::optional<BookEntry>> BookReader::probe_many(const std::vector<const Board *> &boards) const
+    {
+        /*
+        Probes a batch of positions. A first pass advises the kernel to
+        fault in the pages around each key's interpolated position (book
+        keys are roughly uniform), so the binary searches of the second
+        pass mostly hit resident pages instead of blocking on demand
+        faults one probe at a time.
+        */
+        long page = sysconf(_SC_PAGESIZE);
+        for (const Board *board : boards)
+        {
+            Bitboard key = polyglot_key(*board);
+            if (this->_size)
+            {
+                // Interpolate the likely entry offset from the key.
+                size_t guess = (size_t)((long double)key / (long double)BB_ALL * (this->_size - 1));
+                size_t offset = guess * _BOOK_ENTRY_SIZE / page * page;
+                madvise((void *)(this->_data + offset), page * 2, MADV_WILLNEED);
+            }
+        }
+
+        std::vector<std::optional<BookEntry>> results;
+        results.reserve(boards.size());
+        for (size_t i = 0; i < boards.size(); ++i)
+        {
+            results.push_back(this->find(*boards[i]));
+        }
+        return results;
+    }
+}
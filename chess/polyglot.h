@@ -0,0 +1,64 @@
+/*
+This is a line-for-line remake of niklasf's 'python-chess' in C++
+All credit for the original code and algorithms go to niklasf and his credits
+The original source code can be found here: https://github.com/niklasf/python-chess
+*/
+
+#include "chess.cpp"
+
+namespace chess
+{
+    Bitboard polyglot_key(const Board &);
+
+    class BookEntry
+    {
+        /*
+        One 16-byte Polyglot book record: the position key, the raw
+        16-bit move, its weight and the learn value.
+        */
+
+    public:
+        Bitboard key;
+        unsigned short raw_move;
+        unsigned short weight;
+        unsigned int learn;
+
+        Move move(const Board &) const;
+    };
+
+    class BookReader
+    {
+        /*
+        A memory-mapped Polyglot (.bin) opening book.
+
+        Entries are probed in place with binary search by
+        :func:`chess::polyglot_key()` -- no deserialization and no
+        per-probe allocation beyond the result vector. Keys use the
+        canonical PolyGlot ``Random64`` constants and hashing rules, so
+        books built by other PolyGlot tools probe correctly.
+        */
+
+    public:
+        BookReader(const std::string &);
+
+        ~BookReader();
+
+        size_t size() const;
+
+        BookEntry entry_at(size_t) const;
+
+        std::vector<BookEntry> find_all(const Board &) const;
+
+        std::optional<BookEntry> find(const Board &) const;
+
+        std::vector<std::optional<BookEntry>> probe_many(const std::vector<const Board *> &) const;
+
+        void close();
+
+    private:
+        const unsigned char *_data;
+        size_t _size;
+
+        size_t _lower_bound(Bitboard) const;
+    };
+}
@@ -0,0 +1,1549 @@
+/*
+This is a line-for-line remake of niklasf's 'python-chess' in C++
+All credit for the original code and algorithms go to niklasf and his credits
+The original source code can be found here: https://github.com/niklasf/python-chess
+*/
+
+#include "syzygy.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chess
+{
+    const size_t _CACHE_CAPACITY = 8192;
+
+    const int _WDL_TO_MAP[] = {1, 3, 0, 2, 0};
+    const unsigned char _PA_FLAGS[] = {8, 0, 0, 0, 4};
+    const int _WDL_TO_DTZ[] = {-1, -101, 0, 101, 1};
+
+    class _Geometry
+    {
+        /*
+        The geometric and combinatorial tables of the Syzygy position
+        index: the canonical square classes of the a1-d1-d4 triangle, the
+        diagonal mappings, the king-pair index, the pawn flap/twist
+        orders, and the binomial coefficients. Everything except the
+        literal triangle, flap and twist orders (which define the
+        canonical enumeration) is derived here and cross-checked against
+        the reference values.
+        */
+
+    public:
+        int triangle[64], offdiag[64], flipdiag[64], diag[64], lower[64];
+        int flap[64], ptwist[64], invflap[24], file_to_file[8];
+        short kk_idx[10][64];
+        Bitboard binomial[7][64];
+        Bitboard pawnidx[6][24];
+        Bitboard pfactor[6][4];
+
+        _Geometry()
+        {
+            const int triangle_ref[64] = {
+                6, 0, 1, 2, 2, 1, 0, 6,
+                0, 7, 3, 4, 4, 3, 7, 0,
+                1, 3, 8, 5, 5, 8, 3, 1,
+                2, 4, 5, 9, 9, 5, 4, 2,
+                2, 4, 5, 9, 9, 5, 4, 2,
+                1, 3, 8, 5, 5, 8, 3, 1,
+                0, 7, 3, 4, 4, 3, 7, 0,
+                6, 0, 1, 2, 2, 1, 0, 6};
+            const int flap_ref[64] = {
+                0, 0, 0, 0, 0, 0, 0, 0,
+                0, 6, 12, 18, 18, 12, 6, 0,
+                1, 7, 13, 19, 19, 13, 7, 1,
+                2, 8, 14, 20, 20, 14, 8, 2,
+                3, 9, 15, 21, 21, 15, 9, 3,
+                4, 10, 16, 22, 22, 16, 10, 4,
+                5, 11, 17, 23, 23, 17, 11, 5,
+                0, 0, 0, 0, 0, 0, 0, 0};
+            std::copy(std::begin(triangle_ref), std::end(triangle_ref), this->triangle);
+            std::copy(std::begin(flap_ref), std::end(flap_ref), this->flap);
+
+            for (Square square : SQUARES)
+            {
+                int file = square_file(square), rank = square_rank(square);
+                this->offdiag[square] = rank == file ? 0 : (rank > file ? 1 : -1);
+                this->flipdiag[square] = chess::square(rank, file);
+                this->diag[square] = rank == file ? rank : (rank == 7 - file ? 8 + (7 - file) : 0);
+                // Pawn twist: files a-d top-down by file, mirrored minus
+                // one on the kingside.
+                if (rank >= 1 && rank <= 6)
+                {
+                    int base = 47 - 2 * (6 * std::min(file, 7 - file) + rank - 1);
+                    this->ptwist[square] = file <= 3 ? base : base - 1;
+                }
+                else
+                {
+                    this->ptwist[square] = 0;
+                }
+            }
+
+            // Below-diagonal squares 0-27 by rank, then the diagonal 28-35.
+            int below = 0;
+            for (int rank = 0; rank < 8; ++rank)
+            {
+                for (int file = 0; file < 8; ++file)
+                {
+                    if (rank < file)
+                    {
+                        this->lower[square(file, rank)] = below;
+                        this->lower[this->flipdiag[square(file, rank)]] = below;
+                        ++below;
+                    }
+                }
+            }
+            for (int i = 0; i < 8; ++i)
+            {
+                this->lower[square(i, i)] = 28 + i;
+            }
+
+            for (int i = 0; i < 24; ++i)
+            {
+                this->invflap[i] = square(i / 6, 1 + i % 6);
+            }
+            const int file_to_file_ref[8] = {0, 1, 2, 3, 3, 2, 1, 0};
+            std::copy(std::begin(file_to_file_ref), std::end(file_to_file_ref), this->file_to_file);
+
+            // binomial[k][n] = n choose (k + 1).
+            for (int k = 0; k < 7; ++k)
+            {
+                for (int n = 0; n < 64; ++n)
+                {
+                    Bitboard f = 1, l = 1;
+                    for (int i = 0; i <= k; ++i)
+                    {
+                        f *= n - i;
+                        l *= i + 1;
+                    }
+                    this->binomial[k][n] = n > k ? f / l : 0;
+                }
+            }
+
+            // The king-pair index: for each canonical class of the first
+            // king, number the legal squares of the second king, skipping
+            // the upper-diagonal half when the first king sits on the
+            // diagonal (those positions are flipped onto the lower half).
+            const Square representatives[10] = {B1, C1, D1, C2, D2, D3, A1, B2, C3, D4};
+            short index = 0;
+            for (int k = 0; k < 10; ++k)
+            {
+                Square king = representatives[k];
+                for (Square square : SQUARES)
+                {
+                    if (square == king || square_distance(square, king) <= 1 ||
+                        (this->offdiag[king] == 0 && this->offdiag[square] > 0))
+                    {
+                        this->kk_idx[k][square] = -1;
+                    }
+                    else
+                    {
+                        this->kk_idx[k][square] = index++;
+                    }
+                }
+            }
+            if (index != 462)
+            {
+                throw std::runtime_error("king-pair index enumeration is inconsistent");
+            }
+
+            // Cross-check the derivation against reference rows.
+            const short kk_ref[24] = {-1, -1, -1, 0, 1, 2, 3, 4, -1, -1, -1, 5, 6, 7, 8, 9,
+                                      10, 11, 12, 13, 14, 15, 16, 17};
+            for (int i = 0; i < 24; ++i)
+            {
+                if (this->kk_idx[0][i] != kk_ref[i])
+                {
+                    throw std::runtime_error("king-pair index derivation is inconsistent");
+                }
+            }
+
+            // pawnidx/pfactor: positions of like pawns behind the leading
+            // pawn, grouped by the leading pawn's file.
+            for (int i = 0; i < 6; ++i)
+            {
+                int j = 0;
+                for (int file = 0; file < 4; ++file)
+                {
+                    Bitboard s = 0;
+                    for (int k = 0; k < 6; ++k, ++j)
+                    {
+                        this->pawnidx[i][j] = s;
+                        s += i == 0 ? 1 : this->binomial[i - 1][this->ptwist[this->invflap[j]]];
+                    }
+                    this->pfactor[i][file] = s;
+                }
+            }
+        }
+    };
+
+    const _Geometry &_geometry()
+    {
+        static const _Geometry geometry;
+        return geometry;
+    }
+
+    unsigned int _read_le16(const unsigned char *data)
+    {
+        return data[0] | data[1] << 8;
+    }
+
+    unsigned int _read_le32(const unsigned char *data)
+    {
+        return data[0] | data[1] << 8 | data[2] << 16 | (unsigned int)data[3] << 24;
+    }
+
+    Bitboard _read_be64(const unsigned char *data)
+    {
+        Bitboard value = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            value = value << 8 | data[i];
+        }
+        return value;
+    }
+
+    Bitboard _subfactor(Bitboard k, Bitboard n)
+    {
+        // n choose k.
+        Bitboard f = n, l = 1;
+        for (Bitboard i = 1; i < k; ++i)
+        {
+            f *= n - i;
+            l *= i + 1;
+        }
+        return f / l;
+    }
+
+    void _MappedTable::open_mmap(const std::string &path)
+    {
+        /*
+        Maps the table read-only and shared.
+
+        :throws: :exc:`std::runtime_error` if the file cannot be mapped.
+        */
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("could not open table: \"" + path + "\"");
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) < 0 || st.st_size < 5)
+        {
+            ::close(fd);
+            throw std::runtime_error("could not stat table: \"" + path + "\"");
+        }
+
+        void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            throw std::runtime_error("could not mmap table: \"" + path + "\"");
+        }
+
+        this->path = path;
+        this->data = (const unsigned char *)mapping;
+        this->size = st.st_size;
+    }
+
+    void _MappedTable::close_mmap()
+    {
+        if (this->data)
+        {
+            munmap((void *)this->data, this->size);
+            this->data = nullptr;
+            this->size = 0;
+        }
+    }
+
+    bool _MappedTable::check_magic(const std::optional<std::array<unsigned char, 4>> &magic) const
+    {
+        return magic != std::nullopt && this->size >= 4 &&
+               std::equal(std::begin(*magic), std::end(*magic), this->data);
+    }
+
+    void _calc_symlen(_PairsData &d, size_t s, std::vector<unsigned char> &visited)
+    {
+        const unsigned char *w = d.sympat + 3 * s;
+        size_t s2 = w[2] << 4 | w[1] >> 4;
+        if (s2 == 0x0fff)
+        {
+            d.symlen[s] = 0;
+        }
+        else
+        {
+            size_t s1 = (w[1] & 0xf) << 8 | w[0];
+            if (s1 >= d.symlen.size() || s2 >= d.symlen.size())
+            {
+                throw std::runtime_error("corrupt table: symbol out of range");
+            }
+            if (!visited[s1])
+            {
+                _calc_symlen(d, s1, visited);
+            }
+            if (!visited[s2])
+            {
+                _calc_symlen(d, s2, visited);
+            }
+            d.symlen[s] = d.symlen[s1] + d.symlen[s2] + 1;
+        }
+        visited[s] = 1;
+    }
+
+    const unsigned char *_setup_pairs(_PairsData &d, const unsigned char *data, Bitboard tb_size, Bitboard *size, bool wdl)
+    {
+        d.flags = data[0];
+        if (data[0] & 0x80)
+        {
+            // The whole stream is a single repeated value.
+            d.idxbits = 0;
+            d.min_len = wdl ? data[1] : 0;
+            size[0] = size[1] = size[2] = 0;
+            return data + 2;
+        }
+
+        int blocksize = data[1];
+        int idxbits = data[2];
+        Bitboard real_num_blocks = _read_le32(data + 4);
+        Bitboard num_blocks = real_num_blocks + data[3];
+        int max_len = data[8];
+        int min_len = data[9];
+        int h = max_len - min_len + 1;
+        int num_syms = _read_le16(data + 10 + 2 * h);
+
+        d.blocksize = blocksize;
+        d.idxbits = idxbits;
+        d.offset = data + 10;
+        d.symlen.assign(num_syms, 0);
+        d.sympat = data + 12 + 2 * h;
+        d.min_len = min_len;
+
+        Bitboard num_indices = (tb_size + ((Bitboard)1 << idxbits) - 1) >> idxbits;
+        size[0] = 6 * num_indices;
+        size[1] = 2 * num_blocks;
+        size[2] = ((Bitboard)1 << blocksize) * real_num_blocks;
+
+        std::vector<unsigned char> visited(num_syms, 0);
+        for (int i = 0; i < num_syms; ++i)
+        {
+            if (!visited[i])
+            {
+                _calc_symlen(d, i, visited);
+            }
+        }
+
+        d.base.assign(h, 0);
+        for (int i = h - 2; i >= 0; --i)
+        {
+            d.base[i] = (d.base[i + 1] + _read_le16(d.offset + 2 * i) - _read_le16(d.offset + 2 * i + 2)) / 2;
+        }
+        for (int i = 0; i < h; ++i)
+        {
+            d.base[i] <<= 64 - (min_len + i);
+        }
+
+        return data + 12 + 2 * h + 3 * num_syms + (num_syms & 1);
+    }
+
+    int _PairsData::decompress(Bitboard idx) const
+    {
+        if (!this->idxbits)
+        {
+            return this->min_len;
+        }
+
+        Bitboard mainidx = idx >> this->idxbits;
+        long long litidx = (idx & (((Bitboard)1 << this->idxbits) - 1)) - ((Bitboard)1 << (this->idxbits - 1));
+        Bitboard block = _read_le32(this->indextable + 6 * mainidx);
+        litidx += _read_le16(this->indextable + 6 * mainidx + 4);
+
+        while (litidx < 0)
+        {
+            litidx += _read_le16(this->sizetable + 2 * --block) + 1;
+        }
+        while (litidx > (long long)_read_le16(this->sizetable + 2 * block))
+        {
+            litidx -= _read_le16(this->sizetable + 2 * block++) + 1;
+        }
+
+        const unsigned char *ptr = this->data + (block << this->blocksize);
+
+        int m = this->min_len;
+        Bitboard code = _read_be64(ptr);
+        ptr += 8;
+        int bitcnt = 0;
+        int sym;
+
+        while (true)
+        {
+            int l = m;
+            while (l - m + 1 < (int)this->base.size() && code < this->base[l - m])
+            {
+                ++l;
+            }
+            sym = _read_le16(this->offset + 2 * (l - m)) + ((code - this->base[l - m]) >> (64 - l));
+            if (sym < 0 || sym >= (int)this->symlen.size())
+            {
+                throw std::runtime_error("corrupt table: decoded symbol out of range");
+            }
+            if (litidx < (long long)this->symlen[sym] + 1)
+            {
+                break;
+            }
+            litidx -= (long long)this->symlen[sym] + 1;
+            code <<= l;
+            bitcnt += l;
+            if (bitcnt >= 32)
+            {
+                bitcnt -= 32;
+                Bitboard next = (Bitboard)ptr[0] << 24 | ptr[1] << 16 | ptr[2] << 8 | ptr[3];
+                ptr += 4;
+                code |= next << bitcnt;
+            }
+        }
+
+        const unsigned char *sympat = this->sympat;
+        while (this->symlen[sym] != 0)
+        {
+            const unsigned char *w = sympat + 3 * sym;
+            int s1 = (w[1] & 0xf) << 8 | w[0];
+            if (litidx < (long long)this->symlen[s1] + 1)
+            {
+                sym = s1;
+            }
+            else
+            {
+                litidx -= (long long)this->symlen[s1] + 1;
+                sym = w[2] << 4 | w[1] >> 4;
+            }
+        }
+
+        return sympat[3 * sym];
+    }
+
+    void _set_norm_piece(int enc_type, int num, unsigned char *norm, const unsigned char *pieces)
+    {
+        for (int i = 0; i < num; ++i)
+        {
+            norm[i] = 0;
+        }
+        norm[0] = enc_type == 0 ? 3 : (enc_type == 2 ? 2 : enc_type - 1);
+        for (int i = norm[0]; i < num; i += norm[i])
+        {
+            for (int j = i; j < num && pieces[j] == pieces[i]; ++j)
+            {
+                ++norm[i];
+            }
+        }
+    }
+
+    Bitboard _calc_factors_piece(Bitboard *factor, int num, int order, int enc_type, const unsigned char *norm)
+    {
+        const Bitboard pivfac[] = {31332, 28056, 462};
+        int n = 64 - norm[0];
+        Bitboard f = 1;
+        int i = norm[0];
+        for (int k = 0; i < num || k == order; ++k)
+        {
+            if (k == order)
+            {
+                factor[0] = f;
+                f *= pivfac[enc_type];
+            }
+            else
+            {
+                factor[i] = f;
+                f *= _subfactor(norm[i], n);
+                n -= norm[i];
+                i += norm[i];
+            }
+        }
+        return f;
+    }
+
+    void _set_norm_pawn(const int *pawns, int num, unsigned char *norm, const unsigned char *pieces)
+    {
+        for (int i = 0; i < num; ++i)
+        {
+            norm[i] = 0;
+        }
+        norm[0] = pawns[0];
+        if (pawns[1])
+        {
+            norm[pawns[0]] = pawns[1];
+        }
+        for (int i = pawns[0] + pawns[1]; i < num; i += norm[i])
+        {
+            for (int j = i; j < num && pieces[j] == pieces[i]; ++j)
+            {
+                ++norm[i];
+            }
+        }
+    }
+
+    Bitboard _calc_factors_pawn(Bitboard *factor, int num, int order, int order2, const unsigned char *norm, int file)
+    {
+        const _Geometry &geometry = _geometry();
+        int i = norm[0];
+        if (order2 < 0x0f)
+        {
+            i += norm[i];
+        }
+        int n = 64 - i;
+        Bitboard f = 1;
+        for (int k = 0; i < num || k == order || k == order2; ++k)
+        {
+            if (k == order)
+            {
+                factor[0] = f;
+                f *= geometry.pfactor[norm[0] - 1][file];
+            }
+            else if (k == order2)
+            {
+                factor[norm[0]] = f;
+                f *= _subfactor(norm[norm[0]], 48 - norm[0]);
+            }
+            else
+            {
+                factor[i] = f;
+                f *= _subfactor(norm[i], n);
+                n -= norm[i];
+                i += norm[i];
+            }
+        }
+        return f;
+    }
+
+    void _Table::init(const std::string &path, const std::string &stem)
+    {
+        /*
+        Maps the file and parses the header: the piece orders, index
+        factors and compression dictionaries of every stored value stream.
+
+        :throws: :exc:`std::runtime_error` if the table is malformed.
+        */
+        this->mapping.open_mmap(path);
+        const unsigned char *base = this->mapping.data;
+
+        // Material from the table name, e.g. "KRPvKR".
+        size_t split_at = stem.find('v');
+        std::string white = stem.substr(0, split_at), black = stem.substr(split_at + 1);
+        this->symmetric = white == black;
+        this->num = white.length() + black.length();
+
+        int white_pawns = std::count(std::begin(white), std::end(white), 'P');
+        int black_pawns = std::count(std::begin(black), std::end(black), 'P');
+        this->has_pawns = white_pawns + black_pawns > 0;
+        this->pawns[0] = white_pawns;
+        this->pawns[1] = black_pawns;
+        if (black_pawns > 0 && (white_pawns == 0 || black_pawns < white_pawns))
+        {
+            this->pawns[0] = black_pawns;
+            this->pawns[1] = white_pawns;
+        }
+
+        // Encoding type from the number of singleton piece types.
+        int counts[2][7] = {};
+        for (char c : white)
+        {
+            ++counts[0][*_piece_type_from_symbol(std::tolower(c))];
+        }
+        for (char c : black)
+        {
+            ++counts[1][*_piece_type_from_symbol(std::tolower(c))];
+        }
+        int singles = 0, smallest = 16;
+        for (int color = 0; color < 2; ++color)
+        {
+            for (PieceType piece_type : PIECE_TYPES)
+            {
+                if (counts[color][piece_type] == 1)
+                {
+                    ++singles;
+                }
+                else if (counts[color][piece_type] > 1)
+                {
+                    smallest = std::min(smallest, counts[color][piece_type]);
+                }
+            }
+        }
+        this->enc_type = singles >= 3 ? 0 : (singles == 2 ? 2 : 1 + smallest);
+
+        this->split = base[4] & 1;
+        if ((bool)(base[4] & 2) != this->has_pawns)
+        {
+            throw std::runtime_error("corrupt table (pawn flag mismatch): \"" + path + "\"");
+        }
+
+        const unsigned char *data = base + 5;
+        int num_files = this->has_pawns ? 4 : 1;
+        int num_sides = this->split ? 2 : 1;
+        Bitboard tb_size[4][2], size[4][2][3];
+
+        // Piece orders and index factors.
+        if (this->has_pawns)
+        {
+            int s = 1 + (this->pawns[1] > 0);
+            for (int f = 0; f < 4; ++f)
+            {
+                for (int side = 0; side < 2; ++side)
+                {
+                    _SubTable &sub = this->files[f][side];
+                    for (int i = 0; i < this->num; ++i)
+                    {
+                        sub.pieces[i] = side == 0 ? data[i + s] & 0x0f : data[i + s] >> 4;
+                    }
+                    int order = side == 0 ? data[0] & 0x0f : data[0] >> 4;
+                    int order2 = this->pawns[1] ? (side == 0 ? data[1] & 0x0f : data[1] >> 4) : 0x0f;
+                    _set_norm_pawn(this->pawns, this->num, sub.norm, sub.pieces);
+                    sub.tb_size = _calc_factors_pawn(sub.factor, this->num, order, order2, sub.norm, f);
+                    tb_size[f][side] = sub.tb_size;
+                }
+                data += this->num + s;
+            }
+        }
+        else
+        {
+            for (int side = 0; side < 2; ++side)
+            {
+                _SubTable &sub = this->files[0][side];
+                for (int i = 0; i < this->num; ++i)
+                {
+                    sub.pieces[i] = side == 0 ? data[i + 1] & 0x0f : data[i + 1] >> 4;
+                }
+                int order = side == 0 ? data[0] & 0x0f : data[0] >> 4;
+                _set_norm_piece(this->enc_type, this->num, sub.norm, sub.pieces);
+                sub.tb_size = _calc_factors_piece(sub.factor, this->num, order, this->enc_type, sub.norm);
+                tb_size[0][side] = sub.tb_size;
+            }
+            data += this->num + 1;
+        }
+        data += (data - base) & 1;
+
+        // Compression dictionaries.
+        for (int f = 0; f < num_files; ++f)
+        {
+            for (int side = 0; side < num_sides; ++side)
+            {
+                data = _setup_pairs(this->files[f][side].pairs, data, tb_size[f][side], size[f][side], this->wdl);
+            }
+        }
+
+        // The DTZ value map.
+        this->map = data;
+        if (!this->wdl)
+        {
+            for (int f = 0; f < num_files; ++f)
+            {
+                if (this->files[f][0].pairs.flags & 2)
+                {
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        this->map_idx[f][i] = data + 1 - this->map;
+                        data += 1 + data[0];
+                    }
+                }
+            }
+            data += (data - base) & 1;
+        }
+
+        // Index tables, block size tables and the compressed blocks.
+        for (int f = 0; f < num_files; ++f)
+        {
+            for (int side = 0; side < num_sides; ++side)
+            {
+                this->files[f][side].pairs.indextable = data;
+                data += size[f][side][0];
+            }
+        }
+        for (int f = 0; f < num_files; ++f)
+        {
+            for (int side = 0; side < num_sides; ++side)
+            {
+                this->files[f][side].pairs.sizetable = data;
+                data += size[f][side][1];
+            }
+        }
+        for (int f = 0; f < num_files; ++f)
+        {
+            for (int side = 0; side < num_sides; ++side)
+            {
+                data = base + ((data - base + 0x3f) & ~0x3f);
+                this->files[f][side].pairs.data = data;
+                data += size[f][side][2];
+            }
+        }
+
+        if (data - base > (long)this->mapping.size)
+        {
+            throw std::runtime_error("corrupt table (truncated): \"" + path + "\"");
+        }
+    }
+
+    Bitboard _encode_piece(const _Table &table, const _SubTable &sub, int *pos)
+    {
+        const _Geometry &geometry = _geometry();
+        int n = table.num;
+
+        if (pos[0] & 0x04)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                pos[i] ^= 0x07;
+            }
+        }
+        if (pos[0] & 0x20)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                pos[i] ^= 0x38;
+            }
+        }
+        int i = 0;
+        while (i < n && !geometry.offdiag[pos[i]])
+        {
+            ++i;
+        }
+        if (i < (table.enc_type == 0 ? 3 : 2) && geometry.offdiag[pos[i]] > 0)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                pos[j] = geometry.flipdiag[pos[j]];
+            }
+        }
+
+        Bitboard idx;
+        if (table.enc_type == 0)
+        {
+            int a = pos[1] > pos[0];
+            int b = (pos[2] > pos[0]) + (pos[2] > pos[1]);
+            if (geometry.offdiag[pos[0]])
+            {
+                idx = (Bitboard)geometry.triangle[pos[0]] * 63 * 62 + (Bitboard)(pos[1] - a) * 62 + (pos[2] - b);
+            }
+            else if (geometry.offdiag[pos[1]])
+            {
+                idx = 6 * 63 * 62 + (Bitboard)geometry.diag[pos[0]] * 28 * 62 + (Bitboard)geometry.lower[pos[1]] * 62 + pos[2] - b;
+            }
+            else if (geometry.offdiag[pos[2]])
+            {
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + (Bitboard)geometry.diag[pos[0]] * 7 * 28 +
+                      (Bitboard)(geometry.diag[pos[1]] - a) * 28 + geometry.lower[pos[2]];
+            }
+            else
+            {
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + (Bitboard)geometry.diag[pos[0]] * 7 * 6 +
+                      (Bitboard)(geometry.diag[pos[1]] - a) * 6 + (geometry.diag[pos[2]] - b);
+            }
+            i = 3;
+        }
+        else
+        {
+            idx = geometry.kk_idx[geometry.triangle[pos[0]]][pos[1]];
+            i = 2;
+        }
+        idx *= sub.factor[0];
+
+        while (i < n)
+        {
+            int t = sub.norm[i];
+            std::sort(pos + i, pos + i + t);
+            Bitboard s = 0;
+            for (int m = i; m < i + t; ++m)
+            {
+                int p = pos[m];
+                int skipped = 0;
+                for (int l = 0; l < i; ++l)
+                {
+                    skipped += p > pos[l];
+                }
+                s += geometry.binomial[m - i][p - skipped];
+            }
+            idx += s * sub.factor[i];
+            i += t;
+        }
+        return idx;
+    }
+
+    int _pawn_file(const _Table &table, int *pos)
+    {
+        const _Geometry &geometry = _geometry();
+        for (int i = 1; i < table.pawns[0]; ++i)
+        {
+            if (geometry.flap[pos[0]] > geometry.flap[pos[i]])
+            {
+                std::swap(pos[0], pos[i]);
+            }
+        }
+        return geometry.file_to_file[pos[0] & 0x07];
+    }
+
+    Bitboard _encode_pawn(const _Table &table, const _SubTable &sub, int *pos)
+    {
+        const _Geometry &geometry = _geometry();
+        int n = table.num;
+
+        if (pos[0] & 0x04)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                pos[i] ^= 0x07;
+            }
+        }
+        for (int i = 1; i < table.pawns[0]; ++i)
+        {
+            for (int j = i + 1; j < table.pawns[0]; ++j)
+            {
+                if (geometry.ptwist[pos[i]] < geometry.ptwist[pos[j]])
+                {
+                    std::swap(pos[i], pos[j]);
+                }
+            }
+        }
+
+        int t = table.pawns[0] - 1;
+        Bitboard idx = geometry.pawnidx[t][geometry.flap[pos[0]]];
+        for (int i = t; i > 0; --i)
+        {
+            idx += geometry.binomial[t - i][geometry.ptwist[pos[i]]];
+        }
+        idx *= sub.factor[0];
+
+        // Remaining pawns.
+        int i = table.pawns[0];
+        t = i + table.pawns[1];
+        if (t > i)
+        {
+            std::sort(pos + i, pos + t);
+            Bitboard s = 0;
+            for (int m = i; m < t; ++m)
+            {
+                int p = pos[m];
+                int skipped = 0;
+                for (int l = 0; l < i; ++l)
+                {
+                    skipped += p > pos[l];
+                }
+                s += geometry.binomial[m - i][p - skipped - 8];
+            }
+            idx += s * sub.factor[table.pawns[0]];
+            i = t;
+        }
+
+        // Remaining pieces.
+        while (i < n)
+        {
+            t = sub.norm[i];
+            std::sort(pos + i, pos + i + t);
+            Bitboard s = 0;
+            for (int m = i; m < i + t; ++m)
+            {
+                int p = pos[m];
+                int skipped = 0;
+                for (int l = 0; l < i; ++l)
+                {
+                    skipped += p > pos[l];
+                }
+                s += geometry.binomial[m - i][p - skipped];
+            }
+            idx += s * sub.factor[i];
+            i += t;
+        }
+        return idx;
+    }
+
+    Tablebase::Tablebase()
+    {
+        this->_largest = 0;
+    }
+
+    Tablebase::~Tablebase()
+    {
+        this->close();
+    }
+
+    std::string Tablebase::_material_key(const BaseBoard &board, Color color)
+    {
+        // Material of one side in table naming order (KQRBNP).
+        std::string key = "K";
+        const std::tuple<char, Bitboard> pieces[] = {
+            {'Q', board.queens},
+            {'R', board.rooks},
+            {'B', board.bishops},
+            {'N', board.knights},
+            {'P', board.pawns},
+        };
+        for (auto [symbol, mask] : pieces)
+        {
+            key.append(popcount(mask & board.occupied_co[color]), symbol);
+        }
+        return key;
+    }
+
+    int Tablebase::add_directory(const std::string &directory)
+    {
+        /*
+        Scans *directory* for WDL and DTZ tables matching the
+        :class:`~chess::Board` table metadata (``.rtbw``/``.rtbz``), maps
+        and parses them and returns how many were added.
+        */
+        DIR *dir = opendir(directory.c_str());
+        if (dir == nullptr)
+        {
+            throw std::invalid_argument("not a directory: \"" + directory + "\"");
+        }
+
+        int added = 0;
+        struct dirent *entry;
+        while ((entry = readdir(dir)))
+        {
+            std::string filename = entry->d_name;
+            size_t dot = filename.rfind('.');
+            if (dot == std::string::npos)
+            {
+                continue;
+            }
+
+            std::string stem = filename.substr(0, dot), suffix = filename.substr(dot);
+            bool wdl = Board::tbw_suffix && suffix == *Board::tbw_suffix;
+            bool dtz = Board::tbz_suffix && suffix == *Board::tbz_suffix;
+            if ((!wdl && !dtz) || stem.find('v') == std::string::npos)
+            {
+                continue;
+            }
+
+            _MappedTable probe;
+            probe.open_mmap(directory + "/" + filename);
+            bool magic_ok = probe.check_magic(wdl ? Board::tbw_magic : Board::tbz_magic);
+            probe.close_mmap();
+            if (!magic_ok)
+            {
+                continue;
+            }
+
+            _Table &table = (wdl ? this->_wdl : this->_dtz)[stem];
+            table.wdl = wdl;
+            table.init(directory + "/" + filename, stem);
+
+            this->_largest = std::max<int>(this->_largest, stem.length() - 1);
+            ++added;
+        }
+        closedir(dir);
+        return added;
+    }
+
+    int Tablebase::largest() const
+    {
+        /* The piece count of the largest mapped table, or ``0``. */
+        return this->_largest;
+    }
+
+    const _Table *Tablebase::_lookup(const Board &board, bool wdl, bool &mirrored) const
+    {
+        std::string white = _material_key(board, WHITE);
+        std::string black = _material_key(board, BLACK);
+        const std::unordered_map<std::string, _Table> &tables = wdl ? this->_wdl : this->_dtz;
+
+        auto it = tables.find(white + "v" + black);
+        if (it != std::end(tables))
+        {
+            mirrored = false;
+            return &it->second;
+        }
+        it = tables.find(black + "v" + white);
+        if (it != std::end(tables))
+        {
+            mirrored = true;
+            return &it->second;
+        }
+        return nullptr;
+    }
+
+    int Tablebase::_cached_decompress(const _PairsData &pairs, Bitboard idx)
+    {
+        // A small LRU over decoded values, so hot probes skip the block
+        // walk entirely. Streams are keyed by their address.
+        const void *stream = &pairs;
+        std::string key((const char *)&stream, sizeof(stream));
+        key.append((const char *)&idx, sizeof(idx));
+
+        {
+            std::lock_guard<std::mutex> lock(this->_cache_mutex);
+            auto it = this->_cache.find(key);
+            if (it != std::end(this->_cache))
+            {
+                this->_cache_order.splice(std::begin(this->_cache_order), this->_cache_order, it->second);
+                return std::get<2>(*it->second);
+            }
+        }
+
+        int value = pairs.decompress(idx);
+
+        std::lock_guard<std::mutex> lock(this->_cache_mutex);
+        this->_cache_order.push_front({&pairs, idx, value});
+        this->_cache[key] = std::begin(this->_cache_order);
+        if (this->_cache.size() > _CACHE_CAPACITY)
+        {
+            auto &[old_stream, old_idx, old_value] = this->_cache_order.back();
+            std::string old_key((const char *)&old_stream, sizeof(old_stream));
+            old_key.append((const char *)&old_idx, sizeof(old_idx));
+            this->_cache.erase(old_key);
+            this->_cache_order.pop_back();
+        }
+        return value;
+    }
+
+    int Tablebase::_probe_wdl_table(const Board &board)
+    {
+        if (popcount(board.occupied) == 2)
+        {
+            return 0; // KvK.
+        }
+
+        bool mirrored;
+        const _Table *table = this->_lookup(board, true, mirrored);
+        if (table == nullptr)
+        {
+            throw std::invalid_argument("no wdl table for material: \"" +
+                                        _material_key(board, WHITE) + "v" + _material_key(board, BLACK) + "\"");
+        }
+
+        int cmirror, mirror, bside;
+        if (!table->symmetric)
+        {
+            if (mirrored)
+            {
+                cmirror = 8;
+                mirror = 0x38;
+                bside = board.turn == WHITE;
+            }
+            else
+            {
+                cmirror = mirror = 0;
+                bside = board.turn != WHITE;
+            }
+        }
+        else
+        {
+            cmirror = board.turn == WHITE ? 0 : 8;
+            mirror = board.turn == WHITE ? 0 : 0x38;
+            bside = 0;
+        }
+        if (!table->split)
+        {
+            bside = 0;
+        }
+
+        int pos[7];
+        int value;
+        if (table->has_pawns)
+        {
+            const unsigned char *pc = table->files[0][bside].pieces;
+            int i = 0;
+            while (i < table->pawns[0])
+            {
+                Bitboard bb = board.pieces_mask(pc[i] & 0x07, (pc[i] ^ cmirror) & 8 ? BLACK : WHITE);
+                for (Square square : scan_forward(bb))
+                {
+                    pos[i++] = square ^ mirror;
+                }
+            }
+            int f = _pawn_file(*table, pos);
+            const _SubTable &sub = table->files[f][bside];
+            pc = sub.pieces;
+            while (i < table->num)
+            {
+                Bitboard bb = board.pieces_mask(pc[i] & 0x07, (pc[i] ^ cmirror) & 8 ? BLACK : WHITE);
+                for (Square square : scan_forward(bb))
+                {
+                    pos[i++] = square ^ mirror;
+                }
+            }
+            value = this->_cached_decompress(sub.pairs, _encode_pawn(*table, sub, pos));
+        }
+        else
+        {
+            const _SubTable &sub = table->files[0][bside];
+            int i = 0;
+            while (i < table->num)
+            {
+                Bitboard bb = board.pieces_mask(sub.pieces[i] & 0x07, (sub.pieces[i] ^ cmirror) & 8 ? BLACK : WHITE);
+                for (Square square : scan_forward(bb))
+                {
+                    pos[i++] = square ^ mirror;
+                }
+            }
+            value = this->_cached_decompress(sub.pairs, _encode_piece(*table, sub, pos));
+        }
+
+        return value - 2;
+    }
+
+    int Tablebase::_probe_dtz_table(const Board &board, int wdl, bool &table_ok)
+    {
+        table_ok = true;
+        if (popcount(board.occupied) == 2)
+        {
+            return 0; // KvK.
+        }
+
+        bool mirrored;
+        const _Table *table = this->_lookup(board, false, mirrored);
+        if (table == nullptr)
+        {
+            throw std::invalid_argument("no dtz table for material: \"" +
+                                        _material_key(board, WHITE) + "v" + _material_key(board, BLACK) + "\"");
+        }
+
+        int cmirror, mirror, bside;
+        if (!table->symmetric)
+        {
+            if (mirrored)
+            {
+                cmirror = 8;
+                mirror = 0x38;
+                bside = board.turn == WHITE;
+            }
+            else
+            {
+                cmirror = mirror = 0;
+                bside = board.turn != WHITE;
+            }
+        }
+        else
+        {
+            cmirror = board.turn == WHITE ? 0 : 8;
+            mirror = board.turn == WHITE ? 0 : 0x38;
+            bside = 0;
+        }
+
+        int pos[7];
+        int value;
+        int flags;
+        if (table->has_pawns)
+        {
+            const unsigned char *pc = table->files[0][0].pieces;
+            int i = 0;
+            while (i < table->pawns[0])
+            {
+                Bitboard bb = board.pieces_mask(pc[i] & 0x07, (pc[i] ^ cmirror) & 8 ? BLACK : WHITE);
+                for (Square square : scan_forward(bb))
+                {
+                    pos[i++] = square ^ mirror;
+                }
+            }
+            int f = _pawn_file(*table, pos);
+            const _SubTable &sub = table->files[f][0];
+            flags = sub.pairs.flags;
+            if ((flags & 1) != bside && !table->symmetric)
+            {
+                table_ok = false;
+                return 0;
+            }
+            pc = sub.pieces;
+            while (i < table->num)
+            {
+                Bitboard bb = board.pieces_mask(pc[i] & 0x07, (pc[i] ^ cmirror) & 8 ? BLACK : WHITE);
+                for (Square square : scan_forward(bb))
+                {
+                    pos[i++] = square ^ mirror;
+                }
+            }
+            value = this->_cached_decompress(sub.pairs, _encode_pawn(*table, sub, pos));
+            if (flags & 2)
+            {
+                value = table->map[table->map_idx[f][_WDL_TO_MAP[wdl + 2]] + value];
+            }
+        }
+        else
+        {
+            const _SubTable &sub = table->files[0][0];
+            flags = sub.pairs.flags;
+            if ((flags & 1) != bside && !table->symmetric)
+            {
+                table_ok = false;
+                return 0;
+            }
+            int i = 0;
+            while (i < table->num)
+            {
+                Bitboard bb = board.pieces_mask(sub.pieces[i] & 0x07, (sub.pieces[i] ^ cmirror) & 8 ? BLACK : WHITE);
+                for (Square square : scan_forward(bb))
+                {
+                    pos[i++] = square ^ mirror;
+                }
+            }
+            value = this->_cached_decompress(sub.pairs, _encode_piece(*table, sub, pos));
+            if (flags & 2)
+            {
+                value = table->map[table->map_idx[0][_WDL_TO_MAP[wdl + 2]] + value];
+            }
+        }
+
+        if (!(flags & _PA_FLAGS[wdl + 2]) || (wdl & 1))
+        {
+            value *= 2;
+        }
+        return value;
+    }
+
+    int Tablebase::_probe_ab(Board &board, int alpha, int beta, int &status)
+    {
+        // Search captures first: winning captures may be stored as
+        // don't-cares in the table, so they must be resolved by search.
+        std::vector<Move> captures;
+        auto collect = [&board, &captures](const Move &move)
+        {
+            if (!board.is_en_passant(move))
+            {
+                captures.push_back(move);
+            }
+        };
+        board.generate_legal_captures(BB_ALL, BB_ALL, collect);
+
+        for (const Move &move : captures)
+        {
+            board.push(move);
+            int v = -this->_probe_ab(board, -beta, -alpha, status);
+            board.pop();
+            if (!status)
+            {
+                return 0;
+            }
+            if (v > alpha)
+            {
+                if (v >= beta)
+                {
+                    status = 2;
+                    return v;
+                }
+                alpha = v;
+            }
+        }
+
+        int v = this->_probe_wdl_table(board);
+        if (alpha >= v)
+        {
+            status = 1 + (alpha > 0);
+            return alpha;
+        }
+        status = 1;
+        return v;
+    }
+
+    int Tablebase::_probe_wdl(Board &board, int &status)
+    {
+        status = 1;
+        int v = this->_probe_ab(board, -2, 2, status);
+        if (!status || board.ep_square == std::nullopt)
+        {
+            return v;
+        }
+
+        // En passant is not encoded in the tables: compare against the
+        // en passant captures explicitly.
+        int v1 = -3;
+        std::vector<Move> ep_moves = board.generate_legal_ep();
+        for (const Move &move : ep_moves)
+        {
+            board.push(move);
+            int v0 = -this->_probe_ab(board, -2, 2, status);
+            board.pop();
+            if (!status)
+            {
+                return 0;
+            }
+            if (v0 > v1)
+            {
+                v1 = v0;
+            }
+        }
+        if (v1 > -3)
+        {
+            if (v1 >= v)
+            {
+                v = v1;
+            }
+            else if (v == 0)
+            {
+                // If en passant is the only legal move, it is forced.
+                bool other = false;
+                auto probe = [&board, &other](const Move &move) -> bool
+                {
+                    if (!board.is_en_passant(move))
+                    {
+                        other = true;
+                        return false;
+                    }
+                    return true;
+                };
+                board.generate_legal_moves(BB_ALL, BB_ALL, probe);
+                if (!other)
+                {
+                    v = v1;
+                }
+            }
+        }
+        return v;
+    }
+
+    int Tablebase::_probe_dtz(Board &board, int &status)
+    {
+        // Distance to zeroing, without en passant considerations.
+        status = 1;
+        int wdl = this->_probe_ab(board, -2, 2, status);
+        if (!status || wdl == 0)
+        {
+            return 0;
+        }
+        if (status == 2)
+        {
+            // The best move is a winning capture, which zeroes the clock.
+            return wdl == 2 ? 1 : 101;
+        }
+
+        std::vector<Move> moves = board.generate_legal_moves();
+
+        if (wdl > 0)
+        {
+            // A winning pawn push also zeroes the clock.
+            for (const Move &move : moves)
+            {
+                if (!(board.pawns & BB_SQUARES[move.from_square]) || board.is_capture(move))
+                {
+                    continue;
+                }
+                board.push(move);
+                int v = -this->_probe_ab(board, -2, -wdl + 1, status);
+                board.pop();
+                if (!status)
+                {
+                    return 0;
+                }
+                if (v == wdl)
+                {
+                    return v == 2 ? 1 : 101;
+                }
+            }
+        }
+
+        bool table_ok;
+        int dtz = 1 + this->_probe_dtz_table(board, wdl, table_ok);
+        if (table_ok)
+        {
+            if (wdl & 1)
+            {
+                dtz += 100;
+            }
+            return wdl >= 0 ? dtz : -dtz;
+        }
+
+        // The table only stores the other side to move: minimax one ply.
+        if (wdl > 0)
+        {
+            int best = std::numeric_limits<int>::max();
+            for (const Move &move : moves)
+            {
+                if (board.is_zeroing(move))
+                {
+                    continue;
+                }
+                board.push(move);
+                int v = -this->_probe_dtz(board, status);
+                board.pop();
+                if (!status)
+                {
+                    return 0;
+                }
+                if (v > 0 && v + 1 < best)
+                {
+                    best = v + 1;
+                }
+            }
+            return best;
+        }
+        else
+        {
+            int best = -1;
+            for (const Move &move : moves)
+            {
+                int v;
+                if (board.is_zeroing(move))
+                {
+                    v = -1;
+                }
+                else
+                {
+                    board.push(move);
+                    v = -this->_probe_dtz(board, status) - 1;
+                    board.pop();
+                    if (!status)
+                    {
+                        return 0;
+                    }
+                }
+                if (v < best)
+                {
+                    best = v;
+                }
+            }
+            return best;
+        }
+    }
+
+    int Tablebase::probe_wdl(Board &board)
+    {
+        /*
+        Probes the win/draw/loss value of the position from the side to
+        move's point of view: ``2`` win, ``0`` draw, ``-2`` loss (``1``
+        and ``-1`` for cursed results). Captures and en passant are
+        resolved by search, so every sub-endgame reachable by captures
+        must also have its table added.
+
+        :throws: :exc:`std::invalid_argument` if the position cannot be
+            probed (too many pieces, castling rights, missing table), or
+            :exc:`std::runtime_error` for malformed tables.
+        */
+        if (popcount(board.occupied) > 7)
+        {
+            throw std::invalid_argument("syzygy tables support at most 7 pieces");
+        }
+        if (board.castling_rights)
+        {
+            throw std::invalid_argument("syzygy tables do not cover positions with castling rights");
+        }
+
+        int status = 1;
+        int v = this->_probe_wdl(board, status);
+        if (!status)
+        {
+            throw std::invalid_argument("wdl probe failed");
+        }
+        return v;
+    }
+
+    int Tablebase::probe_dtz(Board &board)
+    {
+        /*
+        Probes the distance-to-zeroing value of the position: the number
+        of half-moves until the next capture, pawn move or game end under
+        optimal play, negative when losing, with cursed results offset by
+        100. See :func:`~chess::Tablebase::probe_wdl()` for the
+        preconditions.
+        */
+        if (popcount(board.occupied) > 7)
+        {
+            throw std::invalid_argument("syzygy tables support at most 7 pieces");
+        }
+        if (board.castling_rights)
+        {
+            throw std::invalid_argument("syzygy tables do not cover positions with castling rights");
+        }
+
+        int status = 1;
+        int v = this->_probe_dtz(board, status);
+        if (!status)
+        {
+            throw std::invalid_argument("dtz probe failed");
+        }
+        if (board.ep_square == std::nullopt)
+        {
+            return v;
+        }
+
+        // En passant: compare against the en passant captures.
+        int v1 = -3;
+        std::vector<Move> ep_moves = board.generate_legal_ep();
+        for (const Move &move : ep_moves)
+        {
+            board.push(move);
+            int v0 = -this->_probe_ab(board, -2, 2, status);
+            board.pop();
+            if (!status)
+            {
+                throw std::invalid_argument("dtz probe failed");
+            }
+            if (v0 > v1)
+            {
+                v1 = v0;
+            }
+        }
+        if (v1 > -3)
+        {
+            v1 = _WDL_TO_DTZ[v1 + 2];
+            if (v < -100)
+            {
+                if (v1 >= 0)
+                {
+                    v = v1;
+                }
+            }
+            else if (v < 0)
+            {
+                if (v1 >= 0 || v1 < -100)
+                {
+                    v = v1;
+                }
+            }
+            else if (v > 100)
+            {
+                if (v1 > 0)
+                {
+                    v = v1;
+                }
+            }
+            else if (v > 0)
+            {
+                if (v1 == 1)
+                {
+                    v = v1;
+                }
+            }
+            else if (v1 >= 0)
+            {
+                v = v1;
+            }
+            else
+            {
+                bool other = false;
+                auto probe = [&board, &other](const Move &move) -> bool
+                {
+                    if (!board.is_en_passant(move))
+                    {
+                        other = true;
+                        return false;
+                    }
+                    return true;
+                };
+                board.generate_legal_moves(BB_ALL, BB_ALL, probe);
+                if (!other)
+                {
+                    v = v1;
+                }
+            }
+        }
+        return v;
+    }
+
+    void Tablebase::close()
+    {
+        /* Unmaps all tables. */
+        for (auto &[key, table] : this->_wdl)
+        {
+            table.mapping.close_mmap();
+        }
+        for (auto &[key, table] : this->_dtz)
+        {
+            table.mapping.close_mmap();
+        }
+        this->_wdl.clear();
+        this->_dtz.clear();
+        this->_largest = 0;
+        this->_cache.clear();
+        this->_cache_order.clear();
+    }
+}
@@ -0,0 +1,138 @@
+/*
+This is a line-for-line remake of niklasf's 'python-chess' in C++
+All credit for the original code and algorithms go to niklasf and his credits
+The original source code can be found here: https://github.com/niklasf/python-chess
+*/
+
+#include "chess.cpp"
+
+#include <list>
+
+namespace chess
+{
+    class _MappedTable
+    {
+        /*
+        A single memory-mapped tablebase file. The mapping is shared
+        (``MAP_SHARED``/``PROT_READ``), so worker processes probing the
+        same tables share physical pages through the page cache.
+        */
+
+    public:
+        std::string path;
+        const unsigned char *data;
+        size_t size;
+
+        void open_mmap(const std::string &);
+
+        void close_mmap();
+
+        bool check_magic(const std::optional<std::array<unsigned char, 4>> &) const;
+    };
+
+    class _PairsData
+    {
+        /* The decompression state of one compressed value stream. */
+
+    public:
+        const unsigned char *indextable;
+        const unsigned char *sizetable;
+        const unsigned char *data;
+        const unsigned char *offset;
+        const unsigned char *sympat;
+        std::vector<unsigned char> symlen;
+        std::vector<Bitboard> base;
+        int blocksize, idxbits, min_len;
+        unsigned char flags;
+
+        int decompress(Bitboard) const;
+    };
+
+    class _SubTable
+    {
+        /*
+        One value stream of a table (per stored side, and per leading
+        pawn file for pawn tables), with its piece order and the factors
+        of the position index.
+        */
+
+    public:
+        _PairsData pairs;
+        unsigned char pieces[7];
+        unsigned char norm[7];
+        Bitboard factor[7];
+        Bitboard tb_size;
+    };
+
+    class _Table
+    {
+        /* A parsed WDL or DTZ table. */
+
+    public:
+        _MappedTable mapping;
+        bool wdl;
+        bool symmetric, has_pawns, split;
+        int num;
+        int pawns[2];
+        int enc_type;
+        _SubTable files[4][2];
+        const unsigned char *map;
+        unsigned short map_idx[4][4];
+
+        void init(const std::string &, const std::string &);
+    };
+
+    class Tablebase
+    {
+        /*
+        A collection of Syzygy tablebases, keyed by material signature
+        (like ``KQvK``) and memory-mapped on demand.
+
+        Probes resolve captures and en passant by searching into
+        sub-tables, following the reference probing algorithm, so
+        :func:`~chess::Tablebase::probe_wdl()` is correct for any
+        position covered by the added tables. Decoded values are kept in
+        a small LRU cache so hot probes skip the block decompression.
+        */
+
+    public:
+        Tablebase();
+
+        ~Tablebase();
+
+        int add_directory(const std::string &);
+
+        int largest() const;
+
+        int probe_wdl(Board &);
+
+        int probe_dtz(Board &);
+
+        void close();
+
+    private:
+        std::unordered_map<std::string, _Table> _wdl;
+        std::unordered_map<std::string, _Table> _dtz;
+        int _largest;
+
+        std::mutex _cache_mutex;
+        std::list<std::tuple<const void *, Bitboard, int>> _cache_order;
+        std::unordered_map<std::string, std::list<std::tuple<const void *, Bitboard, int>>::iterator> _cache;
+
+        const _Table *_lookup(const Board &, bool, bool &) const;
+
+        int _cached_decompress(const _PairsData &, Bitboard);
+
+        int _probe_wdl_table(const Board &);
+
+        int _probe_dtz_table(const Board &, int, bool &);
+
+        int _probe_ab(Board &, int, int, int &);
+
+        int _probe_wdl(Board &, int &);
+
+        int _probe_dtz(Board &, int &);
+
+        static std::string _material_key(const BaseBoard &, Color);
+    };
+}
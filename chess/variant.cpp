@@ -9,83 +9,347 @@ The original source code can be found here: https://github.com/niklasf/python-ch
 
 namespace chess
 {
-    std::string SuicideBoard::aliases[] = {"Suicide", "Suicide chess"};
-    std::optional<std::string> SuicideBoard::uci_variant = "suicide";
-    std::optional<std::string> SuicideBoard::xboard_variant = "suicide";
+    template <typename BoardT>
+    int SuicideTraits::material_balance(const BoardT &board)
+    {
+        return (popcount(board.occupied_co[board.turn]) -
+                popcount(board.occupied_co[!board.turn]));
+    }
 
-    std::optional<std::string> SuicideBoard::tbw_suffix = ".stbw";
-    std::optional<std::string> SuicideBoard::tbz_suffix = ".stbz";
-    std::optional<std::array<unsigned char, 4>> SuicideBoard::tbw_magic = {{0x7b, 0xf6, 0x93, 0x15}};
-    std::optional<std::array<unsigned char, 4>> SuicideBoard::tbz_magic = {{0xe4, 0xcf, 0xe7, 0x23}};
-    std::optional<std::string> SuicideBoard::pawnless_tbw_suffix = ".gtbw";
-    std::optional<std::string> SuicideBoard::pawnless_tbz_suffix = ".gtbz";
-    std::optional<std::array<unsigned char, 4>> SuicideBoard::pawnless_tbw_magic = {{0xbc, 0x55, 0xbc, 0x21}};
-    std::optional<std::array<unsigned char, 4>> SuicideBoard::pawnless_tbz_magic = {{0xd6, 0xf5, 0x1b, 0x50}};
-    bool SuicideBoard::connected_kings = true;
-    bool SuicideBoard::one_king = false;
-    bool SuicideBoard::captures_compulsory = true;
+    template <typename BoardT>
+    bool SuicideTraits::is_variant_end(const BoardT &board)
+    {
+        for (Bitboard has_pieces : board.occupied_co)
+        {
+            if (!has_pieces)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
 
-    chess::Bitboard SuicideBoard::pin_mask(chess::Color color, chess::Square square) const
+    template <typename BoardT>
+    bool SuicideTraits::is_variant_win(const BoardT &board)
     {
-        return chess::BB_ALL;
+        if (!board.occupied_co[board.turn])
+        {
+            return true;
+        }
+        else
+        {
+            return board.is_stalemate() && material_balance(board) < 0;
+        }
     }
 
-    bool SuicideBoard::_attacked_for_king(chess::Bitboard path, chess::Bitboard occupied) const
+    template <typename BoardT>
+    bool SuicideTraits::is_variant_loss(const BoardT &board)
     {
-        return false;
+        if (!board.occupied_co[board.turn])
+        {
+            return false;
+        }
+        else
+        {
+            return board.is_stalemate() && material_balance(board) > 0;
+        }
     }
 
-    chess::Bitboard SuicideBoard::checkers_mask() const
+    template <typename Traits>
+    bool VariantBoard<Traits>::is_variant_end() const
     {
-        return chess::BB_EMPTY;
+        return Traits::is_variant_end(*this);
     }
 
-    bool SuicideBoard::gives_check(chess::Move move) const
+    template <typename Traits>
+    bool VariantBoard<Traits>::is_variant_win() const
     {
-        return false;
+        return Traits::is_variant_win(*this);
     }
 
-    bool SuicideBoard::is_into_check(chess::Move move) const
+    template <typename Traits>
+    bool VariantBoard<Traits>::is_variant_loss() const
     {
-        return false;
+        return Traits::is_variant_loss(*this);
     }
 
-    bool SuicideBoard::was_into_check() const
+    template <typename Traits>
+    bool VariantBoard<Traits>::is_variant_draw() const
     {
-        return false;
+        return Traits::is_variant_draw(*this);
     }
 
-    int SuicideBoard::_material_balance() const
+    template <typename Traits>
+    Bitboard VariantBoard<Traits>::checkers_mask() const
     {
-        return (chess::popcount(this->occupied_co[this->turn]) -
-                chess::popcount(this->occupied_co[!this->turn]));
+        if constexpr (Traits::connected_kings)
+        {
+            return BB_EMPTY;
+        }
+        else
+        {
+            return Board::checkers_mask();
+        }
     }
 
-    bool SuicideBoard::is_variant_end() const
+    template <typename Traits>
+    bool VariantBoard<Traits>::is_check() const
     {
-        for (chess::Bitboard has_pieces : this->occupied_co) {
-            if (!has_pieces) {
-                return true;
+        if constexpr (Traits::connected_kings)
+        {
+            return false;
+        }
+        else
+        {
+            return Board::is_check();
+        }
+    }
+
+    template <typename Traits>
+    bool VariantBoard<Traits>::gives_check(const Move &move)
+    {
+        if constexpr (Traits::connected_kings)
+        {
+            return false;
+        }
+        else
+        {
+            return Board::gives_check(move);
+        }
+    }
+
+    template <typename Traits>
+    bool VariantBoard<Traits>::is_into_check(const Move &move) const
+    {
+        if constexpr (Traits::connected_kings)
+        {
+            return false;
+        }
+        else
+        {
+            return Board::is_into_check(move);
+        }
+    }
+
+    template <typename Traits>
+    bool VariantBoard<Traits>::was_into_check() const
+    {
+        if constexpr (Traits::connected_kings)
+        {
+            return false;
+        }
+        else
+        {
+            return Board::was_into_check();
+        }
+    }
+
+    template <typename Traits>
+    template <typename Visitor>
+    void VariantBoard<Traits>::generate_legal_moves(Bitboard from_mask, Bitboard to_mask, Visitor &&visitor) const
+    {
+        if constexpr (Traits::captures_compulsory)
+        {
+            if (this->is_variant_end())
+            {
+                return;
+            }
+
+            // Captures are compulsory: if any capture exists anywhere,
+            // only captures are legal. There are no check rules, so every
+            // pseudo-legal move passes.
+            bool any_capture = false;
+            auto probe = [&any_capture](const Move &) -> bool
+            {
+                any_capture = true;
+                return false;
+            };
+            this->generate_pseudo_legal_captures(BB_ALL, BB_ALL, probe);
+
+            if (any_capture)
+            {
+                this->generate_pseudo_legal_captures(from_mask, to_mask, visitor);
+            }
+            else
+            {
+                this->generate_pseudo_legal_moves(from_mask, to_mask, visitor);
             }
         }
-        return false;
+        else
+        {
+            Board::generate_legal_moves(from_mask, to_mask, visitor);
+        }
     }
 
-    bool SuicideBoard::is_variant_win() const
+    template <typename Traits>
+    std::vector<Move> VariantBoard<Traits>::generate_legal_moves(Bitboard from_mask, Bitboard to_mask) const
     {
-        if (!this->occupied_co[this->turn]) {
-            return true;
-        } else {
-            return this->is_stalemate() && this->_material_balance() < 0;
+        std::vector<Move> iter;
+        auto collect = [&iter](const Move &move)
+        { iter.push_back(move); };
+        this->generate_legal_moves(from_mask, to_mask, collect);
+        return iter;
+    }
+
+    template <typename Traits>
+    bool VariantBoard<Traits>::has_any_legal_move() const
+    {
+        if constexpr (Traits::captures_compulsory)
+        {
+            bool any = false;
+            auto probe = [&any](const Move &) -> bool
+            {
+                any = true;
+                return false;
+            };
+            this->generate_legal_moves(BB_ALL, BB_ALL, probe);
+            return any;
+        }
+        else
+        {
+            return Board::has_any_legal_move();
+        }
+    }
+
+    template <typename Traits>
+    bool VariantBoard<Traits>::is_legal(const Move &move) const
+    {
+        if constexpr (Traits::captures_compulsory)
+        {
+            if (this->is_variant_end() || !this->is_pseudo_legal(move))
+            {
+                return false;
+            }
+            if (this->is_capture(move))
+            {
+                return true;
+            }
+
+            bool any_capture = false;
+            auto probe = [&any_capture](const Move &) -> bool
+            {
+                any_capture = true;
+                return false;
+            };
+            this->generate_pseudo_legal_captures(BB_ALL, BB_ALL, probe);
+            return !any_capture;
+        }
+        else
+        {
+            return Board::is_legal(move);
         }
     }
 
-    bool SuicideBoard::is_variant_loss() const
+    template <typename Traits>
+    bool VariantBoard<Traits>::is_checkmate() const
     {
-        if (!this->occupied_co[this->turn]) {
+        if constexpr (Traits::connected_kings)
+        {
             return false;
-        } else {
-            return this->is_stalemate() && this->_material_balance() > 0;
         }
+        else
+        {
+            return Board::is_checkmate();
+        }
+    }
+
+    template <typename Traits>
+    bool VariantBoard<Traits>::is_stalemate() const
+    {
+        if constexpr (Traits::connected_kings)
+        {
+            return !this->is_variant_end() && !this->has_any_legal_move();
+        }
+        else
+        {
+            return Board::is_stalemate();
+        }
+    }
+
+    template <typename Traits>
+    std::optional<Outcome> VariantBoard<Traits>::outcome(bool claim_draw)
+    {
+        /*
+        Like :func:`chess::Board::outcome()`, dispatched through the
+        variant traits instead of the base class's non-virtual methods.
+        */
+        if (this->is_variant_loss())
+        {
+            return Outcome(Termination::VARIANT_LOSS, !this->turn);
+        }
+        if (this->is_variant_win())
+        {
+            return Outcome(Termination::VARIANT_WIN, this->turn);
+        }
+        if (this->is_variant_draw())
+        {
+            return Outcome(Termination::VARIANT_DRAW, std::nullopt);
+        }
+
+        if (this->is_checkmate())
+        {
+            return Outcome(Termination::CHECKMATE, !this->turn);
+        }
+        if (this->is_insufficient_material())
+        {
+            return Outcome(Termination::INSUFFICIENT_MATERIAL, std::nullopt);
+        }
+        if (!this->has_any_legal_move())
+        {
+            return Outcome(Termination::STALEMATE, std::nullopt);
+        }
+
+        if (this->is_seventyfive_moves())
+        {
+            return Outcome(Termination::SEVENTYFIVE_MOVES, std::nullopt);
+        }
+        if (this->is_fivefold_repetition())
+        {
+            return Outcome(Termination::FIVEFOLD_REPETITION, std::nullopt);
+        }
+
+        if (claim_draw)
+        {
+            if (this->can_claim_fifty_moves())
+            {
+                return Outcome(Termination::FIFTY_MOVES, std::nullopt);
+            }
+            if (this->can_claim_threefold_repetition())
+            {
+                return Outcome(Termination::THREEFOLD_REPETITION, std::nullopt);
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    template <typename Traits>
+    bool VariantBoard<Traits>::is_game_over(bool claim_draw)
+    {
+        return this->outcome(claim_draw) != std::nullopt;
+    }
+
+    template class VariantBoard<StandardTraits>;
+    template class VariantBoard<SuicideTraits>;
+
+    std::string SuicideBoard::aliases[] = {"Suicide", "Suicide chess"};
+    std::optional<std::string> SuicideBoard::uci_variant = "suicide";
+    std::optional<std::string> SuicideBoard::xboard_variant = "suicide";
+
+    std::optional<std::string> SuicideBoard::tbw_suffix = ".stbw";
+    std::optional<std::string> SuicideBoard::tbz_suffix = ".stbz";
+    std::optional<std::array<unsigned char, 4>> SuicideBoard::tbw_magic = {{0x7b, 0xf6, 0x93, 0x15}};
+    std::optional<std::array<unsigned char, 4>> SuicideBoard::tbz_magic = {{0xe4, 0xcf, 0xe7, 0x23}};
+    std::optional<std::string> SuicideBoard::pawnless_tbw_suffix = ".gtbw";
+    std::optional<std::string> SuicideBoard::pawnless_tbz_suffix = ".gtbz";
+    std::optional<std::array<unsigned char, 4>> SuicideBoard::pawnless_tbw_magic = {{0xbc, 0x55, 0xbc, 0x21}};
+    std::optional<std::array<unsigned char, 4>> SuicideBoard::pawnless_tbz_magic = {{0xd6, 0xf5, 0x1b, 0x50}};
+    bool SuicideBoard::connected_kings = SuicideTraits::connected_kings;
+    bool SuicideBoard::one_king = SuicideTraits::one_king;
+    bool SuicideBoard::captures_compulsory = SuicideTraits::captures_compulsory;
+
+    int SuicideBoard::_material_balance() const
+    {
+        return SuicideTraits::material_balance(*this);
     }
-}
\ No newline at end of file
+}
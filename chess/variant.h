@@ -8,44 +8,151 @@ The original source code can be found here: https://github.com/niklasf/python-ch
 
 namespace chess
 {
-    class SuicideBoard : public chess::Board
+    class StandardTraits
     {
-        public:
-            static std::string aliases[];
-            static std::optional<std::string> uci_variant;
-            static std::optional<std::string> xboard_variant;
-            static std::string starting_fen;
+        /* Traits of standard chess: checks exist, captures are free. */
 
-            static std::optional<std::string> tbw_suffix;
-            static std::optional<std::string> tbz_suffix;
-            static std::optional<std::array<unsigned char, 4>> tbw_magic;
-            static std::optional<std::array<unsigned char, 4>> tbz_magic;
-            static std::optional<std::string> pawnless_tbw_suffix;
-            static std::optional<std::string> pawnless_tbz_suffix;
-            static std::optional<std::array<unsigned char, 4>> pawnless_tbw_magic;
-            static std::optional<std::array<unsigned char, 4>> pawnless_tbz_magic;
-            static bool connected_kings;
-            static bool one_king;
-            static bool captures_compulsory;
+    public:
+        static constexpr bool connected_kings = false;
+        static constexpr bool one_king = true;
+        static constexpr bool captures_compulsory = false;
 
-            chess::Bitboard pin_mask(chess::Color, chess::Square) const;
+        template <typename BoardT>
+        static bool is_variant_end(const BoardT &)
+        {
+            return false;
+        }
 
-            bool _attacked_for_king(chess::Bitboard, chess::Bitboard) const;
+        template <typename BoardT>
+        static bool is_variant_win(const BoardT &)
+        {
+            return false;
+        }
 
-            chess::Bitboard checkers_mask() const;
+        template <typename BoardT>
+        static bool is_variant_loss(const BoardT &)
+        {
+            return false;
+        }
 
-            bool gives_check(chess::Move) const;
+        template <typename BoardT>
+        static bool is_variant_draw(const BoardT &)
+        {
+            return false;
+        }
+    };
+
+    class SuicideTraits
+    {
+        /*
+        Traits of suicide chess: no check rules, captures compulsory,
+        losing all pieces (or being stalemated with less material) wins.
+        */
+
+    public:
+        static constexpr bool connected_kings = true;
+        static constexpr bool one_king = false;
+        static constexpr bool captures_compulsory = true;
+
+        template <typename BoardT>
+        static int material_balance(const BoardT &);
+
+        template <typename BoardT>
+        static bool is_variant_end(const BoardT &);
+
+        template <typename BoardT>
+        static bool is_variant_win(const BoardT &);
+
+        template <typename BoardT>
+        static bool is_variant_loss(const BoardT &);
+
+        template <typename BoardT>
+        static bool is_variant_draw(const BoardT &)
+        {
+            return false;
+        }
+    };
+
+    template <typename Traits>
+    class VariantBoard : public Board
+    {
+        /*
+        A board with compile-time variant dispatch.
+
+        The variant-sensitive entry points re-branch on ``constexpr``
+        traits, so dead variant branches are eliminated and there is no
+        virtual call anywhere: ``VariantBoard<StandardTraits>`` compiles
+        down to the plain :class:`~chess::Board` logic, while
+        ``VariantBoard<SuicideTraits>`` enforces compulsory captures and
+        drops the check rules.
+
+        .. warning::
+            Dispatch is by static type, deliberately without a vtable.
+            Calling through a ``Board*`` or ``Board&`` runs standard-chess
+            logic, exactly as cheap as before.
+        */
+
+    public:
+        using Board::Board;
+
+        bool is_variant_end() const;
+
+        bool is_variant_win() const;
 
-            bool is_into_check(chess::Move) const;
+        bool is_variant_loss() const;
 
-            bool was_into_check() const;
+        bool is_variant_draw() const;
+
+        Bitboard checkers_mask() const;
+
+        bool is_check() const;
+
+        bool gives_check(const Move &);
+
+        bool is_into_check(const Move &) const;
+
+        bool was_into_check() const;
+
+        template <typename Visitor>
+        void generate_legal_moves(Bitboard, Bitboard, Visitor &&) const;
+
+        std::vector<Move> generate_legal_moves(Bitboard = BB_ALL, Bitboard = BB_ALL) const;
+
+        bool has_any_legal_move() const;
+
+        bool is_legal(const Move &) const;
+
+        bool is_checkmate() const;
+
+        bool is_stalemate() const;
+
+        std::optional<Outcome> outcome(bool = false);
+
+        bool is_game_over(bool = false);
+    };
+
+    class SuicideBoard : public VariantBoard<SuicideTraits>
+    {
 
-            int _material_balance() const;
+    public:
+        static std::string aliases[];
+        static std::optional<std::string> uci_variant;
+        static std::optional<std::string> xboard_variant;
 
-            bool is_variant_end() const;
+        static std::optional<std::string> tbw_suffix;
+        static std::optional<std::string> tbz_suffix;
+        static std::optional<std::array<unsigned char, 4>> tbw_magic;
+        static std::optional<std::array<unsigned char, 4>> tbz_magic;
+        static std::optional<std::string> pawnless_tbw_suffix;
+        static std::optional<std::string> pawnless_tbz_suffix;
+        static std::optional<std::array<unsigned char, 4>> pawnless_tbw_magic;
+        static std::optional<std::array<unsigned char, 4>> pawnless_tbz_magic;
+        static bool connected_kings;
+        static bool one_king;
+        static bool captures_compulsory;
 
-            bool is_variant_win() const;
+        using VariantBoard<SuicideTraits>::VariantBoard;
 
-            bool is_variant_loss() const;
+        int _material_balance() const;
     };
-}
\ No newline at end of file
+}